@@ -0,0 +1,340 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Size-class, thread-caching allocator for the game's small heap allocations.
+// One address range is reserved up front and committed in 64 KB spans, each span serving a single size class.
+// The span index of a pointer gives its size class, so ownership and size checks are a range check and a table
+// lookup, and foreign pointers are always recognised and left to the original heap. The size each block was
+// requested with is kept in a side table (one entry per 16-byte granule, committed with its span), because
+// HeapSize(), _msize() and HEAP_ZERO_MEMORY reallocs are defined by it, not by the size class.
+// Threads allocate and free from their own cache and only touch the shared lists (one lock per size class) to
+// move a batch of blocks. Anything above the largest size class returns nullptr so the caller falls back.
+// No Windows headers beyond the page calls, so tools/allocbench can build and stress it on Linux.
+namespace HeapAllocator
+{
+    inline constexpr size_t iSpanSize = 64 * 1024;
+    inline constexpr size_t iReserveSize = size_t(1) << 30;
+    inline constexpr size_t iSpanCount = iReserveSize / iSpanSize;
+    inline constexpr size_t iMaxSize = 32 * 1024;
+    inline constexpr size_t iGranule = 16;
+    inline constexpr uint8_t iNoClass = 0xFF;
+
+    // 16-byte steps up to 128, then four classes per power of two up to 32 KB. Every class keeps 16-byte alignment.
+    inline constexpr auto classSizes = [] {
+        std::array<uint32_t, 8 + 4 * 8> sizes{};
+        size_t i = 0;
+        for (uint32_t iSize = 16; iSize <= 128; iSize += 16)
+            sizes[i++] = iSize;
+        for (uint32_t iPower = 128; iPower < iMaxSize; iPower *= 2) {
+            for (uint32_t iStep = 1; iStep <= 4; iStep++)
+                sizes[i++] = iPower + iStep * (iPower / 4);
+        }
+        return sizes;
+    }();
+
+    inline constexpr size_t iClassCount = classSizes.size();
+
+    // Size class for every 16-byte granule up to iMaxSize
+    inline constexpr auto granuleClasses = [] {
+        std::array<uint8_t, iMaxSize / iGranule + 1> classes{};
+        uint8_t iClass = 0;
+        for (size_t iGranuleIndex = 0; iGranuleIndex < classes.size(); iGranuleIndex++) {
+            while (classSizes[iClass] < iGranuleIndex * iGranule)
+                iClass++;
+            classes[iGranuleIndex] = iClass;
+        }
+        return classes;
+    }();
+
+    inline uint8_t SizeClass(size_t iSize)
+    {
+        return granuleClasses[(iSize + iGranule - 1) / iGranule];
+    }
+
+    // Blocks moved between a thread cache and the shared list at once
+    inline uint32_t BatchSize(uint8_t iClass)
+    {
+        uint32_t iBatch = static_cast<uint32_t>(iSpanSize / classSizes[iClass] / 8);
+        return iBatch < 2 ? 2 : (iBatch > 64 ? 64 : iBatch);
+    }
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Statistics {
+        std::atomic<uint64_t> iAllocations = 0;
+        std::atomic<uint64_t> iFrees = 0;
+        std::atomic<uint64_t> iFallbacks = 0;       // Too large or out of reserve, served by the original heap
+        std::atomic<uint64_t> iForeignFrees = 0;    // Frees of blocks we don't own (allocated before the redirect or too large)
+        std::atomic<uint64_t> iRefills = 0;
+        std::atomic<uint64_t> iReleases = 0;
+        std::atomic<uint64_t> iSpans = 0;
+    };
+
+    inline Statistics stats{};
+
+    // Shared state
+    struct alignas(64) CentralList {
+        std::mutex mutex{};
+        FreeBlock* head = nullptr;
+        uint8_t* bumpCursor = nullptr;      // Unused tail of the class's newest span
+        uint8_t* bumpEnd = nullptr;
+    };
+
+    inline uint8_t* base = nullptr;
+    inline uint16_t* requestedSizes = nullptr;     // iMaxSize fits, indexed by granule
+    inline std::atomic<size_t> iNextSpan = 0;
+    inline uint8_t spanClasses[iSpanCount]{};
+    inline CentralList centralLists[iClassCount]{};
+
+    // Per-thread state, trivially constructible so first use on a thread doesn't allocate
+    struct ThreadCache {
+        FreeBlock* heads[iClassCount];
+        uint32_t counts[iClassCount];
+        uint64_t iAllocations;
+        uint64_t iFrees;
+    };
+
+    inline thread_local ThreadCache threadCache{};
+
+    inline bool Initialize()
+    {
+        if (base)
+            return true;
+
+        constexpr size_t iSizeTableSize = iReserveSize / iGranule * sizeof(uint16_t);
+#ifdef _WIN32
+        base = static_cast<uint8_t*>(VirtualAlloc(nullptr, iReserveSize, MEM_RESERVE, PAGE_NOACCESS));
+        requestedSizes = static_cast<uint16_t*>(VirtualAlloc(nullptr, iSizeTableSize, MEM_RESERVE, PAGE_NOACCESS));
+        if (base && !requestedSizes) {
+            VirtualFree(base, 0, MEM_RELEASE);
+            base = nullptr;
+        }
+#else
+        void* reserved = mmap(nullptr, iReserveSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        void* table = mmap(nullptr, iSizeTableSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reserved != MAP_FAILED && table == MAP_FAILED)
+            munmap(reserved, iReserveSize);
+        base = reserved == MAP_FAILED || table == MAP_FAILED ? nullptr : static_cast<uint8_t*>(reserved);
+        requestedSizes = base ? static_cast<uint16_t*>(table) : nullptr;
+#endif
+        if (!base)
+            return false;
+
+        memset(spanClasses, iNoClass, sizeof(spanClasses));
+        return true;
+    }
+
+    inline bool Owns(const void* p)
+    {
+        uintptr_t iOffset = reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(base);
+        return base && iOffset < iReserveSize && spanClasses[iOffset / iSpanSize] != iNoClass;
+    }
+
+    // Only valid for owned pointers
+    inline size_t Capacity(const void* p)
+    {
+        return classSizes[spanClasses[static_cast<size_t>(static_cast<const uint8_t*>(p) - base) / iSpanSize]];
+    }
+
+    // Size the block was last allocated or reallocated with, what HeapSize() and _msize() report. Only for owned pointers.
+    inline size_t Size(const void* p)
+    {
+        return requestedSizes[static_cast<size_t>(static_cast<const uint8_t*>(p) - base) / iGranule];
+    }
+
+    inline void SetSize(const void* p, size_t iSize)
+    {
+        requestedSizes[static_cast<size_t>(static_cast<const uint8_t*>(p) - base) / iGranule] = static_cast<uint16_t>(iSize);
+    }
+
+    inline uint8_t* CommitSpan(uint8_t iClass)
+    {
+        size_t iSpan = iNextSpan.fetch_add(1, std::memory_order_relaxed);
+        if (iSpan >= iSpanCount)
+            return nullptr;
+
+        uint8_t* span = base + iSpan * iSpanSize;
+        uint16_t* sizes = requestedSizes + iSpan * (iSpanSize / iGranule);
+        constexpr size_t iSizesSize = iSpanSize / iGranule * sizeof(uint16_t);
+#ifdef _WIN32
+        if (!VirtualAlloc(span, iSpanSize, MEM_COMMIT, PAGE_READWRITE) || !VirtualAlloc(sizes, iSizesSize, MEM_COMMIT, PAGE_READWRITE))
+            return nullptr;
+#else
+        if (mprotect(span, iSpanSize, PROT_READ | PROT_WRITE) != 0 || mprotect(sizes, iSizesSize, PROT_READ | PROT_WRITE) != 0)
+            return nullptr;
+#endif
+        spanClasses[iSpan] = iClass;
+        stats.iSpans.fetch_add(1, std::memory_order_relaxed);
+        return span;
+    }
+
+    inline void FlushCounters(ThreadCache& cache)
+    {
+        stats.iAllocations.fetch_add(cache.iAllocations, std::memory_order_relaxed);
+        stats.iFrees.fetch_add(cache.iFrees, std::memory_order_relaxed);
+        cache.iAllocations = 0;
+        cache.iFrees = 0;
+    }
+
+    // Moves up to one batch from the shared list (or fresh span memory) into the thread cache
+    inline bool Refill(ThreadCache& cache, uint8_t iClass)
+    {
+        CentralList& central = centralLists[iClass];
+        uint32_t iBatch = BatchSize(iClass);
+        uint32_t iSize = classSizes[iClass];
+        uint32_t iMoved = 0;
+        {
+            std::scoped_lock lock(central.mutex);
+            while (iMoved < iBatch) {
+                FreeBlock* block = central.head;
+                if (block) {
+                    central.head = block->next;
+                }
+                else {
+                    if (central.bumpCursor == central.bumpEnd) {
+                        uint8_t* span = CommitSpan(iClass);
+                        if (!span)
+                            break;
+                        central.bumpCursor = span;
+                        central.bumpEnd = span + (iSpanSize / iSize) * iSize;
+                    }
+                    block = reinterpret_cast<FreeBlock*>(central.bumpCursor);
+                    central.bumpCursor += iSize;
+                }
+                block->next = cache.heads[iClass];
+                cache.heads[iClass] = block;
+                iMoved++;
+            }
+        }
+
+        cache.counts[iClass] += iMoved;
+        stats.iRefills.fetch_add(1, std::memory_order_relaxed);
+        FlushCounters(cache);
+        return iMoved != 0;
+    }
+
+    // Hands iCount blocks from the thread cache back to the shared list
+    inline void Release(ThreadCache& cache, uint8_t iClass, uint32_t iCount)
+    {
+        if (iCount == 0)
+            return;
+
+        FreeBlock* first = cache.heads[iClass];
+        FreeBlock* last = first;
+        for (uint32_t i = 1; i < iCount; i++)
+            last = last->next;
+        cache.heads[iClass] = last->next;
+        cache.counts[iClass] -= iCount;
+
+        CentralList& central = centralLists[iClass];
+        {
+            std::scoped_lock lock(central.mutex);
+            last->next = central.head;
+            central.head = first;
+        }
+
+        stats.iReleases.fetch_add(1, std::memory_order_relaxed);
+        FlushCounters(cache);
+    }
+
+    // nullptr when the request is too large or the reserve is exhausted, the caller should use its fallback
+    inline void* Allocate(size_t iSize)
+    {
+        if (!base || iSize > iMaxSize) {
+            stats.iFallbacks.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        ThreadCache& cache = threadCache;
+        uint8_t iClass = SizeClass(iSize ? iSize : 1);
+        if (!cache.heads[iClass] && !Refill(cache, iClass)) {
+            stats.iFallbacks.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        FreeBlock* block = cache.heads[iClass];
+        cache.heads[iClass] = block->next;
+        cache.counts[iClass]--;
+        cache.iAllocations++;
+        SetSize(block, iSize);
+        return block;
+    }
+
+    // Only for owned pointers
+    inline void Free(void* p)
+    {
+        ThreadCache& cache = threadCache;
+        uint8_t iClass = spanClasses[static_cast<size_t>(static_cast<uint8_t*>(p) - base) / iSpanSize];
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = cache.heads[iClass];
+        cache.heads[iClass] = block;
+        cache.iFrees++;
+
+        uint32_t iBatch = BatchSize(iClass);
+        if (++cache.counts[iClass] > 2 * iBatch)
+            Release(cache, iClass, iBatch);
+    }
+
+    // Changes the size of an owned block without moving it, false if the new size doesn't fit its size class.
+    // With bZero the bytes past the old size are cleared, as HEAP_ZERO_MEMORY does for HeapReAlloc().
+    inline bool Resize(void* p, size_t iSize, bool bZero = false)
+    {
+        size_t iOldSize = Size(p);
+        if (iSize > Capacity(p))
+            return false;
+
+        if (bZero && iSize > iOldSize)
+            memset(static_cast<uint8_t*>(p) + iOldSize, 0, iSize - iOldSize);
+        SetSize(p, iSize);
+        return true;
+    }
+
+    // Only for owned pointers. nullptr if the new size needs the fallback heap, p is left untouched in that case.
+    inline void* Reallocate(void* p, size_t iSize, bool bZero = false)
+    {
+        if (iSize > Capacity(p) / 2 && Resize(p, iSize, bZero))
+            return p;
+
+        size_t iOldSize = Size(p);
+        void* result = Allocate(iSize);
+        if (!result)
+            return nullptr;
+
+        memcpy(result, p, iSize < iOldSize ? iSize : iOldSize);
+        if (bZero && iSize > iOldSize)
+            memset(static_cast<uint8_t*>(result) + iOldSize, 0, iSize - iOldSize);
+        Free(p);
+        return result;
+    }
+
+    // Returns a thread's cached blocks to the shared lists, call on thread exit
+    inline void FlushThreadCache()
+    {
+        if (!base)
+            return;
+
+        ThreadCache& cache = threadCache;
+        for (uint8_t iClass = 0; iClass < iClassCount; iClass++)
+            Release(cache, iClass, cache.counts[iClass]);
+        FlushCounters(cache);
+    }
+
+    inline size_t CommittedBytes()
+    {
+        return stats.iSpans.load(std::memory_order_relaxed) * iSpanSize;
+    }
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <safetyhook.hpp>
+
+#include "lighthook.hpp"
+
+// Benchmark mode.
+// Hooks are grouped by feature and can be switched off at runtime without reinstalling them. Gated mid hooks go
+// through a per-slot dispatch function that checks the group flag, LightHooks are toggled through Enable().
+// Frame times are recorded per variant (everything on, then each group off in turn) and compared against each
+// other and against a stored baseline.
+namespace Benchmark
+{
+    enum class Group : uint8_t { HUD, FOV, Framerate, Shadows, Count };
+
+    inline const char* GroupName(Group group)
+    {
+        switch (group) {
+        case Group::HUD: return "HUD";
+        case Group::FOV: return "FOV";
+        case Group::Framerate: return "Framerate";
+        case Group::Shadows: return "Shadows";
+        default: return "Unknown";
+        }
+    }
+
+    inline constexpr size_t iGroupCount = static_cast<size_t>(Group::Count);
+    inline std::atomic<bool> groupEnabled[iGroupCount] = { true, true, true, true };
+
+    // Set before hooks are installed. Without it Gate() returns the handler as-is and costs nothing.
+    inline bool bActive = false;
+
+    // Gated mid hooks
+    struct GatedHook {
+        Group group;
+        safetyhook::MidHookFn fn;
+    };
+
+    inline constexpr size_t iMaxGatedHooks = 64;
+    inline GatedHook gatedHooks[iMaxGatedHooks]{};
+    inline size_t iGatedHookCount = 0;
+
+    template<size_t N>
+    void Dispatch(SafetyHookContext& ctx)
+    {
+        const GatedHook& hook = gatedHooks[N];
+        if (groupEnabled[static_cast<size_t>(hook.group)].load(std::memory_order_relaxed))
+            hook.fn(ctx);
+    }
+
+    template<size_t... N>
+    constexpr std::array<safetyhook::MidHookFn, sizeof...(N)> MakeDispatchTable(std::index_sequence<N...>)
+    {
+        return { &Dispatch<N>... };
+    }
+
+    inline constexpr auto dispatchTable = MakeDispatchTable(std::make_index_sequence<iMaxGatedHooks>{});
+
+    inline safetyhook::MidHookFn Gate(Group group, safetyhook::MidHookFn fn)
+    {
+        if (!bActive || iGatedHookCount == iMaxGatedHooks)
+            return fn;
+
+        gatedHooks[iGatedHookCount] = { group, fn };
+        return dispatchTable[iGatedHookCount++];
+    }
+
+    // Gated LightHooks, the enabled state is saved when the group is switched off and restored afterwards
+    struct TrackedLightHook {
+        Group group;
+        LightHook* hook;
+        bool bEnabled;
+    };
+
+    inline std::mutex lightHooksMutex{};
+    inline std::vector<TrackedLightHook> lightHooks{};
+
+    inline void Track(Group group, LightHook& hook)
+    {
+        std::scoped_lock lock(lightHooksMutex);
+        if (bActive && hook)
+            lightHooks.push_back({ group, &hook, hook.IsEnabled() });
+    }
+
+    // Enables a LightHook from outside the benchmark. While its group is switched off the state is applied when the
+    // group comes back on instead.
+    inline void Enable(LightHook& hook, bool bEnable)
+    {
+        std::scoped_lock lock(lightHooksMutex);
+        for (auto& tracked : lightHooks) {
+            if (tracked.hook == &hook && !groupEnabled[static_cast<size_t>(tracked.group)].load()) {
+                tracked.bEnabled = bEnable;
+                return;
+            }
+        }
+        hook.Enable(bEnable);
+    }
+
+    inline bool HasHooks(Group group)
+    {
+        std::scoped_lock lock(lightHooksMutex);
+        for (size_t i = 0; i < iGatedHookCount; i++) {
+            if (gatedHooks[i].group == group)
+                return true;
+        }
+        return std::any_of(lightHooks.begin(), lightHooks.end(), [&](const TrackedLightHook& tracked) { return tracked.group == group; });
+    }
+
+    inline void SetGroup(Group group, bool bEnable)
+    {
+        size_t iGroup = static_cast<size_t>(group);
+        std::scoped_lock lock(lightHooksMutex);
+        if (groupEnabled[iGroup].load() == bEnable)
+            return;
+
+        for (auto& tracked : lightHooks) {
+            if (tracked.group != group)
+                continue;
+
+            if (!bEnable)
+                tracked.bEnabled = tracked.hook->IsEnabled();
+            tracked.hook->Enable(bEnable && tracked.bEnabled);
+        }
+        groupEnabled[iGroup] = bEnable;
+    }
+
+    // Variant 0 runs with everything on, every other variant switches one group off
+    struct Variant {
+        std::string sName;
+        int iDisabledGroup;     // -1 = none
+    };
+
+    // iSkippedGroups = bit per group that must stay on, e.g. because switching it off changes the workload
+    inline std::vector<Variant> Variants(uint32_t iSkippedGroups = 0)
+    {
+        std::vector<Variant> variants{ { "All", -1 } };
+        for (size_t i = 0; i < iGroupCount; i++) {
+            if (!(iSkippedGroups & (1u << i)) && HasHooks(static_cast<Group>(i)))
+                variants.push_back({ std::string("No") + GroupName(static_cast<Group>(i)), static_cast<int>(i) });
+        }
+        return variants;
+    }
+
+    inline void ApplyVariant(const Variant& variant)
+    {
+        for (size_t i = 0; i < iGroupCount; i++)
+            SetGroup(static_cast<Group>(i), static_cast<int>(i) != variant.iDisabledGroup);
+    }
+
+    // Frame time recording, fed from the once-per-frame frame cap hook
+    inline constexpr size_t iMaxSamples = 1 << 18;
+
+    inline std::vector<float> samples{};
+    inline std::atomic<size_t> iSampleCount = 0;
+    inline std::atomic<bool> bRecording = false;
+    inline int64_t iLastFrameTime = 0;
+    inline double fTicksToMs = 0.0;
+
+    inline void Frame()
+    {
+        if (!bRecording.load(std::memory_order_relaxed))
+            return;
+
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        if (iLastFrameTime) {
+            size_t iIndex = iSampleCount.fetch_add(1, std::memory_order_relaxed);
+            if (iIndex < iMaxSamples)
+                samples[iIndex] = static_cast<float>((counter.QuadPart - iLastFrameTime) * fTicksToMs);
+        }
+        iLastFrameTime = counter.QuadPart;
+    }
+
+    inline void Start()
+    {
+        if (samples.empty())
+            samples.resize(iMaxSamples);
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        fTicksToMs = 1000.0 / (double)frequency.QuadPart;
+        iLastFrameTime = 0;
+        iSampleCount = 0;
+        bRecording = true;
+    }
+
+    // Returns the recorded frame times in milliseconds
+    inline std::vector<float> Stop()
+    {
+        bRecording = false;
+        size_t iCount = std::min(iSampleCount.load(), iMaxSamples);
+        return std::vector<float>(samples.begin(), samples.begin() + iCount);
+    }
+
+    // Statistics
+    struct Stats {
+        size_t iCount = 0;
+        double fMean = 0.0;
+        double fStdDev = 0.0;
+        double fP50 = 0.0;
+        double fP95 = 0.0;
+        double fP99 = 0.0;
+
+        // 95% confidence interval half-width of the mean. Frame times are autocorrelated, so treat it as a lower bound.
+        double CI95() const { return iCount > 1 ? 1.96 * fStdDev / std::sqrt((double)iCount) : 0.0; }
+    };
+
+    inline Stats Summarize(std::vector<float> frameTimes)
+    {
+        Stats stats{};
+        stats.iCount = frameTimes.size();
+        if (frameTimes.empty())
+            return stats;
+
+        double fSum = 0.0;
+        for (float fFrameTime : frameTimes)
+            fSum += fFrameTime;
+        stats.fMean = fSum / (double)stats.iCount;
+
+        double fSquares = 0.0;
+        for (float fFrameTime : frameTimes)
+            fSquares += (fFrameTime - stats.fMean) * (fFrameTime - stats.fMean);
+        stats.fStdDev = stats.iCount > 1 ? std::sqrt(fSquares / (double)(stats.iCount - 1)) : 0.0;
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+        auto percentile = [&](double fPercentile) { return (double)frameTimes[std::min(stats.iCount - 1, (size_t)(fPercentile * (double)stats.iCount))]; };
+        stats.fP50 = percentile(0.50);
+        stats.fP95 = percentile(0.95);
+        stats.fP99 = percentile(0.99);
+        return stats;
+    }
+
+    // Difference of means (b - a) with a Welch 95% confidence interval half-width
+    inline std::pair<double, double> Compare(const Stats& a, const Stats& b)
+    {
+        double fVariance = 0.0;
+        if (a.iCount > 1)
+            fVariance += a.fStdDev * a.fStdDev / (double)a.iCount;
+        if (b.iCount > 1)
+            fVariance += b.fStdDev * b.fStdDev / (double)b.iCount;
+        return { b.fMean - a.fMean, 1.96 * std::sqrt(fVariance) };
+    }
+
+    // Baseline file: one line per variant, "name count mean stddev p50 p95 p99"
+    inline std::map<std::string, Stats> ReadBaseline(const std::filesystem::path& path)
+    {
+        std::map<std::string, Stats> baseline{};
+        std::ifstream file(path);
+        std::string sLine;
+        while (std::getline(file, sLine)) {
+            if (sLine.empty() || sLine[0] == ';')
+                continue;
+
+            std::istringstream line(sLine);
+            std::string sName;
+            Stats stats{};
+            if (line >> sName >> stats.iCount >> stats.fMean >> stats.fStdDev >> stats.fP50 >> stats.fP95 >> stats.fP99)
+                baseline[sName] = stats;
+        }
+        return baseline;
+    }
+
+    inline bool WriteBaseline(const std::filesystem::path& path, const std::map<std::string, Stats>& results)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+
+        file << "; BerserkFix benchmark baseline\n";
+        file << "; variant count mean_ms stddev_ms p50_ms p95_ms p99_ms\n";
+        for (const auto& [sName, stats] : results)
+            file << sName << " " << stats.iCount << " " << stats.fMean << " " << stats.fStdDev << " " << stats.fP50 << " " << stats.fP95 << " " << stats.fP99 << "\n";
+        return true;
+    }
+
+    inline bool WriteReport(const std::filesystem::path& path, const std::vector<Variant>& variants, const std::map<std::string, Stats>& results, const std::map<std::string, Stats>& baseline)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+
+        auto formatDelta = [](const std::pair<double, double>& delta, double fReference) {
+            char sBuffer[128];
+            snprintf(sBuffer, sizeof(sBuffer), "%+.3f ms +/- %.3f (%+.2f%%)%s", delta.first, delta.second,
+                fReference > 0.0 ? 100.0 * delta.first / fReference : 0.0,
+                std::abs(delta.first) > delta.second ? " significant" : "");
+            return std::string(sBuffer);
+        };
+
+        file << "BerserkFix benchmark\n\n";
+        for (const Variant& variant : variants) {
+            auto result = results.find(variant.sName);
+            if (result == results.end())
+                continue;
+
+            const Stats& stats = result->second;
+            char sBuffer[256];
+            snprintf(sBuffer, sizeof(sBuffer), "%-12s frames %7zu  mean %.3f ms +/- %.3f  stddev %.3f  p50 %.3f  p95 %.3f  p99 %.3f\n",
+                variant.sName.c_str(), stats.iCount, stats.fMean, stats.CI95(), stats.fStdDev, stats.fP50, stats.fP95, stats.fP99);
+            file << sBuffer;
+
+            // Cost of the group = all hooks on minus this group off
+            if (variant.iDisabledGroup >= 0) {
+                if (auto all = results.find("All"); all != results.end())
+                    file << "             cost of " << GroupName(static_cast<Group>(variant.iDisabledGroup)) << ": " << formatDelta(Compare(stats, all->second), stats.fMean) << "\n";
+            }
+
+            if (auto base = baseline.find(variant.sName); base != baseline.end())
+                file << "             vs baseline: " << formatDelta(Compare(base->second, stats), base->second.fMean) << "\n";
+            else
+                file << "             vs baseline: none\n";
+        }
+        return true;
+    }
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <safetyhook.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "handlers.hpp"
+
+// Hook input capture and replay.
+// While a capture is running, every call to a handler-backed hook records the registers the handlers use, the
+// globals they read and the memory they dereference, both before and after the handler ran. Records are fixed size
+// and appended lock-free into a preallocated buffer, then written out as a binary trace. tools/hookreplay loads the
+// trace on any platform, feeds each record back through the same handler and diffs the result against what the
+// game produced.
+namespace Capture
+{
+    enum class Site : uint16_t {
+        AspectRatio, GlobalFOV, GameplayFOV, GameplayLockOnFOV,
+        FadeWidth, FadeHeight, PauseCapture, PauseBackground, MissionSelectCapture, MissionSelectBackground, MenuBackgrounds,
+        HUDBackgrounds1, HUDBackgrounds2, HUDBackgrounds3, HUDBackgrounds4, HUDBackgrounds5, HUDBackgrounds6,
+        CurrentFrametime, ControllerInputSpeed, KeyboardInputSpeed,
+        Count
+    };
+
+    // Register that the dereferenced memory is relative to
+    enum class Base : uint8_t { None, Rbx, Rcx, Rdx, R8, Rsp };
+
+    struct SiteInfo {
+        const char* sName;
+        void (*handler)(SafetyHookContext&);
+        Base base;
+        uint16_t iOffset;
+        uint16_t iSize;
+    };
+
+    inline constexpr size_t iSiteCount = static_cast<size_t>(Site::Count);
+    inline constexpr size_t iMaxMemory = 16;
+
+    // Same order as Site. Memory ranges cover everything the handler reads or writes through a pointer.
+    inline constexpr SiteInfo sites[iSiteCount] = {
+        { "AspectRatio", Handlers::AspectRatio, Base::Rbx, 0x1B0, 4 },
+        { "GlobalFOV", Handlers::GlobalFOV, Base::None, 0, 0 },
+        { "GameplayFOV", Handlers::GameplayFOV, Base::None, 0, 0 },
+        { "GameplayLockOnFOV", Handlers::GameplayLockOnFOV, Base::None, 0, 0 },
+        { "FadeWidth", Handlers::FadeWidth, Base::None, 0, 0 },
+        { "FadeHeight", Handlers::FadeHeight, Base::None, 0, 0 },
+        { "PauseCapture", Handlers::PauseCapture, Base::Rsp, 0x48, 16 },
+        { "PauseBackground", Handlers::PauseBackground, Base::Rcx, 0x20, 8 },
+        { "MissionSelectCapture", Handlers::MissionSelectCapture, Base::Rsp, 0x40, 16 },
+        { "MissionSelectBackground", Handlers::MissionSelectBackground, Base::R8, 0x20, 16 },
+        { "MenuBackgrounds", Handlers::MenuBackgrounds, Base::Rsp, 0x50, 16 },
+        { "HUDBackgrounds1", Handlers::HUDBackgrounds1, Base::Rdx, 0x20, 16 },
+        { "HUDBackgrounds2", Handlers::HUDBackgrounds2, Base::Rsp, 0x40, 16 },
+        { "HUDBackgrounds3", Handlers::HUDBackgrounds3, Base::Rdx, 0x20, 16 },
+        { "HUDBackgrounds4", Handlers::HUDBackgrounds4, Base::Rdx, 0x20, 16 },
+        { "HUDBackgrounds5", Handlers::HUDBackgrounds5, Base::Rsp, 0x30, 16 },
+        { "HUDBackgrounds6", Handlers::HUDBackgrounds6, Base::R8, 0x20, 16 },
+        { "CurrentFrametime", Handlers::CurrentFrametime, Base::None, 0, 0 },
+        { "ControllerInputSpeed", Handlers::ControllerInputSpeed, Base::None, 0, 0 },
+        { "KeyboardInputSpeed", Handlers::KeyboardInputSpeed, Base::None, 0, 0 },
+    };
+
+    // Trace format, little-endian. A TraceHeader followed by iRecordCount Records.
+    inline constexpr uint32_t iTraceMagic = 0x5448424B;    // "KBHT"
+    inline constexpr uint32_t iTraceVersion = 1;
+
+    struct TraceHeader {
+        uint32_t iMagic;
+        uint32_t iVersion;
+        uint32_t iRecordSize;
+        uint32_t iSiteCount;
+        uint64_t iRecordCount;
+        int64_t iFrequency;     // Timestamp ticks per second
+    };
+
+    struct Globals {
+        float fAspectRatio;
+        float fNativeAspect;
+        float fAspectMultiplier;
+        float fHUDWidth;
+        float fHUDHeight;
+        float fHUDWidthOffset;
+        float fHUDHeightOffset;
+        float fGameplayFOVMulti;
+        float fCurrentFrametime;
+        int32_t iCurrentResX;
+        int32_t iCurrentResY;
+        uint32_t iReserved;
+    };
+
+    // The registers the handlers read or write
+    struct Registers {
+        uint64_t rax, rbx, rcx, rdx, r8, rsp, rflags;
+        float xmm[8];           // Low lane of xmm0-xmm7
+    };
+
+    struct Record {
+        uint16_t iSite;
+        uint16_t iMemorySize;
+        uint32_t iThreadId;
+        int64_t iTimestamp;
+        Globals globals;
+        Registers in;
+        Registers out;
+        uint8_t memoryIn[iMaxMemory];
+        uint8_t memoryOut[iMaxMemory];
+    };
+
+    static_assert(sizeof(TraceHeader) == 32);
+    static_assert(sizeof(Globals) == 48);
+    static_assert(sizeof(Registers) == 88);
+    static_assert(sizeof(Record) == 272);
+
+    inline Globals ReadGlobals()
+    {
+        return { fAspectRatio, fNativeAspect, fAspectMultiplier, fHUDWidth, fHUDHeight, fHUDWidthOffset, fHUDHeightOffset,
+            fGameplayFOVMulti, fCurrentFrametime, iCurrentResX, iCurrentResY, 0 };
+    }
+
+    inline void ApplyGlobals(const Globals& globals)
+    {
+        fAspectRatio = globals.fAspectRatio;
+        fNativeAspect = globals.fNativeAspect;
+        fAspectMultiplier = globals.fAspectMultiplier;
+        fHUDWidth = globals.fHUDWidth;
+        fHUDHeight = globals.fHUDHeight;
+        fHUDWidthOffset = globals.fHUDWidthOffset;
+        fHUDHeightOffset = globals.fHUDHeightOffset;
+        fGameplayFOVMulti = globals.fGameplayFOVMulti;
+        fCurrentFrametime = globals.fCurrentFrametime;
+        iCurrentResX = globals.iCurrentResX;
+        iCurrentResY = globals.iCurrentResY;
+    }
+
+    inline Registers ReadRegisters(const SafetyHookContext& ctx)
+    {
+        Registers registers{ ctx.rax, ctx.rbx, ctx.rcx, ctx.rdx, ctx.r8, ctx.rsp, ctx.rflags, {} };
+        const safetyhook::Xmm* xmm[8] = { &ctx.xmm0, &ctx.xmm1, &ctx.xmm2, &ctx.xmm3, &ctx.xmm4, &ctx.xmm5, &ctx.xmm6, &ctx.xmm7 };
+        for (size_t i = 0; i < 8; i++)
+            registers.xmm[i] = xmm[i]->f32[0];
+        return registers;
+    }
+
+    inline void WriteRegisters(SafetyHookContext& ctx, const Registers& registers)
+    {
+        ctx.rax = registers.rax;
+        ctx.rbx = registers.rbx;
+        ctx.rcx = registers.rcx;
+        ctx.rdx = registers.rdx;
+        ctx.r8 = registers.r8;
+        ctx.rsp = registers.rsp;
+        ctx.rflags = registers.rflags;
+        safetyhook::Xmm* xmm[8] = { &ctx.xmm0, &ctx.xmm1, &ctx.xmm2, &ctx.xmm3, &ctx.xmm4, &ctx.xmm5, &ctx.xmm6, &ctx.xmm7 };
+        for (size_t i = 0; i < 8; i++)
+            xmm[i]->f32[0] = registers.xmm[i];
+    }
+
+    inline uintptr_t& BaseRegister(SafetyHookContext& ctx, Base base)
+    {
+        switch (base) {
+        case Base::Rbx: return ctx.rbx;
+        case Base::Rcx: return ctx.rcx;
+        case Base::Rdx: return ctx.rdx;
+        case Base::R8: return ctx.r8;
+        default: return ctx.rsp;
+        }
+    }
+
+    // Plain copy by default. The fix swaps in a fault-tolerant copy, since the handlers' pointer checks don't
+    // guarantee the memory is readable.
+    inline bool (*ReadMemory)(void* destination, const void* source, size_t iSize) = [](void* destination, const void* source, size_t iSize) {
+        memcpy(destination, source, iSize);
+        return true;
+    };
+
+    inline int64_t Now()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    inline uint32_t ThreadId()
+    {
+#ifdef _WIN32
+        return GetCurrentThreadId();
+#else
+        return 0;
+#endif
+    }
+
+    // Recording
+    inline constexpr size_t iMaxRecords = 1 << 17;
+
+    inline std::vector<Record> records{};
+    inline std::atomic<size_t> iRecordCount = 0;
+    inline std::atomic<bool> bRecording = false;
+    inline int64_t iEndTime = 0;
+    inline int64_t iFrequency = 1;
+
+    // Set before hooks are installed. Without it Wrap() returns the handler as-is and costs nothing.
+    inline bool bActive = false;
+
+    template<Site S>
+    void Run(SafetyHookContext& ctx)
+    {
+        constexpr const SiteInfo& site = sites[static_cast<size_t>(S)];
+        if (!bRecording.load(std::memory_order_relaxed)) {
+            site.handler(ctx);
+            return;
+        }
+
+        int64_t iTimestamp = Now();
+        if (iTimestamp >= iEndTime) {
+            bRecording.store(false, std::memory_order_relaxed);
+            site.handler(ctx);
+            return;
+        }
+
+        Record record{};
+        record.iSite = static_cast<uint16_t>(S);
+        record.iThreadId = ThreadId();
+        record.iTimestamp = iTimestamp;
+        record.globals = ReadGlobals();
+        record.in = ReadRegisters(ctx);
+
+        const void* memory = nullptr;
+        if constexpr (site.base != Base::None) {
+            memory = reinterpret_cast<const void*>(BaseRegister(ctx, site.base) + site.iOffset);
+            if (ReadMemory(record.memoryIn, memory, site.iSize))
+                record.iMemorySize = site.iSize;
+        }
+
+        site.handler(ctx);
+
+        record.out = ReadRegisters(ctx);
+        if (record.iMemorySize && !ReadMemory(record.memoryOut, memory, site.iSize))
+            record.iMemorySize = 0;
+
+        size_t iIndex = iRecordCount.fetch_add(1, std::memory_order_relaxed);
+        if (iIndex < iMaxRecords)
+            records[iIndex] = record;
+    }
+
+    template<size_t... N>
+    constexpr std::array<safetyhook::MidHookFn, sizeof...(N)> MakeRunTable(std::index_sequence<N...>)
+    {
+        return { &Run<static_cast<Site>(N)>... };
+    }
+
+    inline constexpr auto runTable = MakeRunTable(std::make_index_sequence<iSiteCount>{});
+
+    inline safetyhook::MidHookFn Wrap(Site site)
+    {
+        if (!bActive)
+            return sites[static_cast<size_t>(site)].handler;
+        return runTable[static_cast<size_t>(site)];
+    }
+
+    inline bool Start(double fSeconds, int64_t iTicksPerSecond)
+    {
+        if (bRecording.load())
+            return false;
+
+        if (records.empty())
+            records.resize(iMaxRecords);
+
+        iFrequency = iTicksPerSecond;
+        iRecordCount = 0;
+        iEndTime = Now() + static_cast<int64_t>(fSeconds * (double)iTicksPerSecond);
+        bRecording = true;
+        return true;
+    }
+
+    inline void Stop()
+    {
+        bRecording = false;
+    }
+
+    inline size_t RecordCount()
+    {
+        return std::min(iRecordCount.load(), iMaxRecords);
+    }
+
+    inline size_t DroppedRecords()
+    {
+        size_t iCount = iRecordCount.load();
+        return iCount > iMaxRecords ? iCount - iMaxRecords : 0;
+    }
+
+    inline bool Write(const std::string& sPath)
+    {
+        std::ofstream file(sPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        TraceHeader header{ iTraceMagic, iTraceVersion, sizeof(Record), static_cast<uint32_t>(iSiteCount), RecordCount(), iFrequency };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), header.iRecordCount * sizeof(Record));
+        return static_cast<bool>(file);
+    }
+
+    // Returns an error message, empty on success
+    inline std::string Load(const std::string& sPath, TraceHeader& header, std::vector<Record>& loaded)
+    {
+        std::ifstream file(sPath, std::ios::binary);
+        if (!file)
+            return "cannot open " + sPath;
+
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.iMagic != iTraceMagic)
+            return "not a hook capture trace";
+        if (header.iVersion != iTraceVersion || header.iRecordSize != sizeof(Record))
+            return "unsupported trace version " + std::to_string(header.iVersion);
+        if (header.iSiteCount > iSiteCount)
+            return "trace has more hook sites than this build knows about";
+
+        loaded.resize(header.iRecordCount);
+        if (!file.read(reinterpret_cast<char*>(loaded.data()), header.iRecordCount * sizeof(Record)))
+            return "truncated trace";
+        return {};
+    }
+}
@@ -6,6 +6,27 @@
 #include <spdlog/sinks/base_sink.h>
 #include <safetyhook.hpp>
 
+#include "hookarena.hpp"
+#include "lighthook.hpp"
+#include "swapchain.hpp"
+#include "scheduler.hpp"
+#include "handlers.hpp"
+#include "timeline.hpp"
+#include "benchmark.hpp"
+#include "xref.hpp"
+#include "signatures.hpp"
+#include "scancache.hpp"
+#include "allocator.hpp"
+#include "filecache.hpp"
+#include "layout.hpp"
+#include "metrics.hpp"
+#include "capture.hpp"
+#include "prepatch.hpp"
+#include "symbolmap.hpp"
+
+#include <intrin.h>
+#include <shared_mutex>
+
 HMODULE baseModule = GetModuleHandle(NULL);
 HMODULE thisModule; // Fix DLL
 
@@ -25,18 +46,63 @@ inipp::Ini<char> ini;
 std::string sConfigFile = sFixName + ".ini";
 std::pair DesktopDimensions = { 0,0 };
 
+// Scan cache
+std::string sScanCacheFile = sFixName + ".cache";
+ScanCache::Cache scanCache;
+bool bScanCacheDirty = false;
+
+// Pre-patched executable
+std::string sPrePatchFile = sFixName + ".patches";
+PrePatch::Manifest prePatch;
+
 // Ini variables
 bool bCustomRes;
 int iCustomResX = 1280;
 int iCustomResY = 720;
 bool bBorderlessMode;
 bool bWindowedMode;
+bool bFlipModel;
+int iFlipModelBufferCount = 3;
+bool bFlipModelTearing = true;
 bool bFixFOV;
 bool bFixAspect;
 bool bFixHUD;
+bool bCoalesceInput;
 float fFramerateCap;
+bool bAdaptiveGameSpeed;
+float fAdaptiveMinFramerate = 30.00f;
+float fAdaptiveSmoothing = 0.10f;
 float fGameplayFOVMulti;
 int iShadowResolution;
+bool bThreadScheduling;
+int iThreadRecheckInterval = 5;
+uintptr_t iRenderThreadRVA = 0;
+Scheduler::Policy ThreadPolicies[3];
+bool bTimeline;
+bool bTimelineCaptureOnStartup;
+int iTimelineHotkey = VK_F11;
+float fTimelineDuration = 10.00f;
+float fTimelineLongFrame = 1.50f;
+bool bBenchmark;
+int iBenchmarkHotkey = VK_F10;
+float fBenchmarkDuration = 60.00f;
+int iBenchmarkRounds = 1;
+bool bBenchmarkUpdateBaseline;
+bool bScanCache;
+bool bHookArena;
+bool bHeapAllocator;
+int iHeapStatsInterval = 60;
+bool bFileCache;
+int iFileCacheSize = 512;
+int iFileReadAhead = 8;
+int iFileCacheMinSize = 16;
+bool bFileCacheMemoryMap;
+bool bLiveResize;
+bool bMetrics;
+bool bHookCapture;
+int iHookCaptureHotkey = VK_F9;
+float fHookCaptureDuration = 10.00f;
+bool bSymbolMap;
 
 // Aspect ratio + HUD stuff
 float fPi = (float)3.141592653;
@@ -52,24 +118,18 @@ float fHUDHeightOffset;
 int iCurrentResX;
 int iCurrentResY;
 float fCurrentFrametime = 0.0166666f;
+float fGameSpeedStep = 0.0166666f;
 
 void CalculateAspectRatio(bool bLog)
 {
-    // Calculate aspect ratio
-    fAspectRatio = (float)iCurrentResX / (float)iCurrentResY;
-    fAspectMultiplier = fAspectRatio / fNativeAspect;
-
-    // HUD variables
-    fHUDWidth = iCurrentResY * fNativeAspect;
-    fHUDHeight = (float)iCurrentResY;
-    fHUDWidthOffset = (float)(iCurrentResX - fHUDWidth) / 2;
-    fHUDHeightOffset = 0;
-    if (fAspectRatio < fNativeAspect) {
-        fHUDWidth = (float)iCurrentResX;
-        fHUDHeight = (float)iCurrentResX / fNativeAspect;
-        fHUDWidthOffset = 0;
-        fHUDHeightOffset = (float)(iCurrentResY - fHUDHeight) / 2;
-    }
+    // Calculate aspect ratio and HUD variables
+    Layout::Values values = Layout::Calculate(iCurrentResX, iCurrentResY, fNativeAspect);
+    fAspectRatio = values.fAspectRatio;
+    fAspectMultiplier = values.fAspectMultiplier;
+    fHUDWidth = values.fHUDWidth;
+    fHUDHeight = values.fHUDHeight;
+    fHUDWidthOffset = values.fHUDWidthOffset;
+    fHUDHeightOffset = values.fHUDHeightOffset;
 
     if (bLog) {
         // Log details about current resolution
@@ -208,6 +268,17 @@ void Configuration()
     spdlog::info("Config Parse: bWindowedMode: {}", bWindowedMode);
     spdlog::info("Config Parse: bBorderlessMode: {}", bBorderlessMode);
 
+    inipp::get_value(ini.sections["Flip Model"], "Enabled", bFlipModel);
+    inipp::get_value(ini.sections["Flip Model"], "BufferCount", iFlipModelBufferCount);
+    inipp::get_value(ini.sections["Flip Model"], "AllowTearing", bFlipModelTearing);
+    if (iFlipModelBufferCount < 2 || iFlipModelBufferCount > 8) {
+        iFlipModelBufferCount = std::clamp(iFlipModelBufferCount, 2, 8);
+        spdlog::warn("Config Parse: iFlipModelBufferCount value invalid, clamped to {}", iFlipModelBufferCount);
+    }
+    spdlog::info("Config Parse: bFlipModel: {}", bFlipModel);
+    spdlog::info("Config Parse: iFlipModelBufferCount: {}", iFlipModelBufferCount);
+    spdlog::info("Config Parse: bFlipModelTearing: {}", bFlipModelTearing);
+
     inipp::get_value(ini.sections["Fix FOV"], "Enabled", bFixFOV);
     spdlog::info("Config Parse: bFixFOV: {}", bFixFOV);
 
@@ -217,6 +288,9 @@ void Configuration()
     inipp::get_value(ini.sections["Fix HUD"], "Enabled", bFixHUD);
     spdlog::info("Config Parse: bFixHUD: {}", bFixHUD);
 
+    inipp::get_value(ini.sections["Input Coalescing"], "Enabled", bCoalesceInput);
+    spdlog::info("Config Parse: bCoalesceInput: {}", bCoalesceInput);
+
     inipp::get_value(ini.sections["Gameplay FOV"], "Multiplier", fGameplayFOVMulti);
     if ((float)fGameplayFOVMulti < 0.10f || (float)fGameplayFOVMulti > 3.00f) {
         fGameplayFOVMulti = std::clamp((float)fGameplayFOVMulti, 0.10f, 3.00f);
@@ -229,7 +303,25 @@ void Configuration()
         fFramerateCap = std::clamp((float)fFramerateCap, 10.00f, 500.00f);
         spdlog::warn("Config Parse: fFramerateCap value invalid, clamped to {}", fFramerateCap);
     }
+    inipp::get_value(ini.sections["Framerate Cap"], "AdaptiveGameSpeed", bAdaptiveGameSpeed);
+    inipp::get_value(ini.sections["Framerate Cap"], "AdaptiveMinFramerate", fAdaptiveMinFramerate);
+    if (fAdaptiveMinFramerate < 10.00f || fAdaptiveMinFramerate > 60.00f) {
+        fAdaptiveMinFramerate = std::clamp(fAdaptiveMinFramerate, 10.00f, 60.00f);
+        spdlog::warn("Config Parse: fAdaptiveMinFramerate value invalid, clamped to {}", fAdaptiveMinFramerate);
+    }
+    if (fAdaptiveMinFramerate > fFramerateCap) {
+        fAdaptiveMinFramerate = fFramerateCap;
+        spdlog::warn("Config Parse: fAdaptiveMinFramerate is above fFramerateCap, clamped to {}", fAdaptiveMinFramerate);
+    }
+    inipp::get_value(ini.sections["Framerate Cap"], "AdaptiveSmoothing", fAdaptiveSmoothing);
+    if (fAdaptiveSmoothing < 0.01f || fAdaptiveSmoothing > 1.00f) {
+        fAdaptiveSmoothing = std::clamp(fAdaptiveSmoothing, 0.01f, 1.00f);
+        spdlog::warn("Config Parse: fAdaptiveSmoothing value invalid, clamped to {}", fAdaptiveSmoothing);
+    }
     spdlog::info("Config Parse: fFramerateCap: {}", fFramerateCap);
+    spdlog::info("Config Parse: bAdaptiveGameSpeed: {}", bAdaptiveGameSpeed);
+    spdlog::info("Config Parse: fAdaptiveMinFramerate: {}", fAdaptiveMinFramerate);
+    spdlog::info("Config Parse: fAdaptiveSmoothing: {}", fAdaptiveSmoothing);
 
     inipp::get_value(ini.sections["Shadow Quality"], "Resolution", iShadowResolution);
     if (iShadowResolution < 64 || iShadowResolution > 16384) {
@@ -238,6 +330,136 @@ void Configuration()
     }
     spdlog::info("Config Parse: iShadowResolution: {}", iShadowResolution);
 
+    inipp::get_value(ini.sections["Thread Scheduling"], "Enabled", bThreadScheduling);
+    inipp::get_value(ini.sections["Thread Scheduling"], "RecheckInterval", iThreadRecheckInterval);
+    if (iThreadRecheckInterval < 1 || iThreadRecheckInterval > 60) {
+        iThreadRecheckInterval = std::clamp(iThreadRecheckInterval, 1, 60);
+        spdlog::warn("Config Parse: iThreadRecheckInterval value invalid, clamped to {}", iThreadRecheckInterval);
+    }
+    std::string sRenderThreadRVA = "0";
+    inipp::get_value(ini.sections["Thread Scheduling"], "RenderThreadRVA", sRenderThreadRVA);
+    iRenderThreadRVA = (uintptr_t)Util::HexStringToInt(sRenderThreadRVA);
+    spdlog::info("Config Parse: bThreadScheduling: {}", bThreadScheduling);
+    spdlog::info("Config Parse: iThreadRecheckInterval: {}", iThreadRecheckInterval);
+    spdlog::info("Config Parse: iRenderThreadRVA: {:x}", iRenderThreadRVA);
+
+    const char* sThreadClasses[] = { "Main", "Render", "Worker" };
+    for (int i = 0; i < 3; i++) {
+        std::string sAffinity = "All";
+        int iPriority = 0;
+        inipp::get_value(ini.sections["Thread Scheduling"], std::string(sThreadClasses[i]) + "Affinity", sAffinity);
+        inipp::get_value(ini.sections["Thread Scheduling"], std::string(sThreadClasses[i]) + "Priority", iPriority);
+        inipp::get_value(ini.sections["Thread Scheduling"], std::string(sThreadClasses[i]) + "DisablePowerThrottling", ThreadPolicies[i].bDisablePowerThrottling);
+        ThreadPolicies[i].affinity = Scheduler::ParseAffinity(sAffinity);
+        ThreadPolicies[i].iPriority = std::clamp(iPriority, -2, 2);
+        spdlog::info("Config Parse: {} thread: Affinity = {}, Priority = {}, DisablePowerThrottling = {}", sThreadClasses[i], sAffinity, ThreadPolicies[i].iPriority, ThreadPolicies[i].bDisablePowerThrottling);
+    }
+
+    inipp::get_value(ini.sections["Timeline Capture"], "Enabled", bTimeline);
+    inipp::get_value(ini.sections["Timeline Capture"], "CaptureOnStartup", bTimelineCaptureOnStartup);
+    std::string sTimelineHotkey = "0x7A";
+    inipp::get_value(ini.sections["Timeline Capture"], "Hotkey", sTimelineHotkey);
+    iTimelineHotkey = Util::HexStringToInt(sTimelineHotkey);
+    inipp::get_value(ini.sections["Timeline Capture"], "Duration", fTimelineDuration);
+    if (fTimelineDuration < 1.00f || fTimelineDuration > 120.00f) {
+        fTimelineDuration = std::clamp(fTimelineDuration, 1.00f, 120.00f);
+        spdlog::warn("Config Parse: fTimelineDuration value invalid, clamped to {}", fTimelineDuration);
+    }
+    inipp::get_value(ini.sections["Timeline Capture"], "LongFrameThreshold", fTimelineLongFrame);
+    if (fTimelineLongFrame < 1.00f || fTimelineLongFrame > 10.00f) {
+        fTimelineLongFrame = std::clamp(fTimelineLongFrame, 1.00f, 10.00f);
+        spdlog::warn("Config Parse: fTimelineLongFrame value invalid, clamped to {}", fTimelineLongFrame);
+    }
+    spdlog::info("Config Parse: bTimeline: {}", bTimeline);
+    spdlog::info("Config Parse: bTimelineCaptureOnStartup: {}", bTimelineCaptureOnStartup);
+    spdlog::info("Config Parse: iTimelineHotkey: {:x}", iTimelineHotkey);
+    spdlog::info("Config Parse: fTimelineDuration: {}", fTimelineDuration);
+    spdlog::info("Config Parse: fTimelineLongFrame: {}", fTimelineLongFrame);
+
+    inipp::get_value(ini.sections["Benchmark"], "Enabled", bBenchmark);
+    std::string sBenchmarkHotkey = "0x79";
+    inipp::get_value(ini.sections["Benchmark"], "Hotkey", sBenchmarkHotkey);
+    iBenchmarkHotkey = Util::HexStringToInt(sBenchmarkHotkey);
+    inipp::get_value(ini.sections["Benchmark"], "Duration", fBenchmarkDuration);
+    if (fBenchmarkDuration < 5.00f || fBenchmarkDuration > 600.00f) {
+        fBenchmarkDuration = std::clamp(fBenchmarkDuration, 5.00f, 600.00f);
+        spdlog::warn("Config Parse: fBenchmarkDuration value invalid, clamped to {}", fBenchmarkDuration);
+    }
+    inipp::get_value(ini.sections["Benchmark"], "Rounds", iBenchmarkRounds);
+    if (iBenchmarkRounds < 1 || iBenchmarkRounds > 10) {
+        iBenchmarkRounds = std::clamp(iBenchmarkRounds, 1, 10);
+        spdlog::warn("Config Parse: iBenchmarkRounds value invalid, clamped to {}", iBenchmarkRounds);
+    }
+    inipp::get_value(ini.sections["Benchmark"], "UpdateBaseline", bBenchmarkUpdateBaseline);
+    Benchmark::bActive = bBenchmark;
+    spdlog::info("Config Parse: bBenchmark: {}", bBenchmark);
+    spdlog::info("Config Parse: iBenchmarkHotkey: {:x}", iBenchmarkHotkey);
+    spdlog::info("Config Parse: fBenchmarkDuration: {}", fBenchmarkDuration);
+    spdlog::info("Config Parse: iBenchmarkRounds: {}", iBenchmarkRounds);
+    spdlog::info("Config Parse: bBenchmarkUpdateBaseline: {}", bBenchmarkUpdateBaseline);
+
+    inipp::get_value(ini.sections["Hook Capture"], "Enabled", bHookCapture);
+    std::string sHookCaptureHotkey = "0x78";
+    inipp::get_value(ini.sections["Hook Capture"], "Hotkey", sHookCaptureHotkey);
+    iHookCaptureHotkey = Util::HexStringToInt(sHookCaptureHotkey);
+    inipp::get_value(ini.sections["Hook Capture"], "Duration", fHookCaptureDuration);
+    if (fHookCaptureDuration < 1.00f || fHookCaptureDuration > 120.00f) {
+        fHookCaptureDuration = std::clamp(fHookCaptureDuration, 1.00f, 120.00f);
+        spdlog::warn("Config Parse: fHookCaptureDuration value invalid, clamped to {}", fHookCaptureDuration);
+    }
+    Capture::bActive = bHookCapture;
+    spdlog::info("Config Parse: bHookCapture: {}", bHookCapture);
+    spdlog::info("Config Parse: iHookCaptureHotkey: {:x}", iHookCaptureHotkey);
+    spdlog::info("Config Parse: fHookCaptureDuration: {}", fHookCaptureDuration);
+
+    inipp::get_value(ini.sections["Symbol Map"], "Enabled", bSymbolMap);
+    SymbolMap::bEnabled = bSymbolMap;
+    spdlog::info("Config Parse: bSymbolMap: {}", bSymbolMap);
+
+    inipp::get_value(ini.sections["Scan Cache"], "Enabled", bScanCache);
+    spdlog::info("Config Parse: bScanCache: {}", bScanCache);
+
+    inipp::get_value(ini.sections["Hook Arena"], "Enabled", bHookArena);
+    spdlog::info("Config Parse: bHookArena: {}", bHookArena);
+
+    inipp::get_value(ini.sections["Heap Allocator"], "Enabled", bHeapAllocator);
+    inipp::get_value(ini.sections["Heap Allocator"], "StatsInterval", iHeapStatsInterval);
+    if (iHeapStatsInterval < 0 || iHeapStatsInterval > 3600) {
+        iHeapStatsInterval = std::clamp(iHeapStatsInterval, 0, 3600);
+        spdlog::warn("Config Parse: iHeapStatsInterval value invalid, clamped to {}", iHeapStatsInterval);
+    }
+    spdlog::info("Config Parse: bHeapAllocator: {}", bHeapAllocator);
+    spdlog::info("Config Parse: iHeapStatsInterval: {}", iHeapStatsInterval);
+
+    inipp::get_value(ini.sections["File Cache"], "Enabled", bFileCache);
+    inipp::get_value(ini.sections["File Cache"], "CacheSize", iFileCacheSize);
+    if (iFileCacheSize < 16 || iFileCacheSize > 8192) {
+        iFileCacheSize = std::clamp(iFileCacheSize, 16, 8192);
+        spdlog::warn("Config Parse: iFileCacheSize value invalid, clamped to {}", iFileCacheSize);
+    }
+    inipp::get_value(ini.sections["File Cache"], "ReadAhead", iFileReadAhead);
+    if (iFileReadAhead < 0 || iFileReadAhead > 128) {
+        iFileReadAhead = std::clamp(iFileReadAhead, 0, 128);
+        spdlog::warn("Config Parse: iFileReadAhead value invalid, clamped to {}", iFileReadAhead);
+    }
+    inipp::get_value(ini.sections["File Cache"], "MinFileSize", iFileCacheMinSize);
+    if (iFileCacheMinSize < 0 || iFileCacheMinSize > 65536) {
+        iFileCacheMinSize = std::clamp(iFileCacheMinSize, 0, 65536);
+        spdlog::warn("Config Parse: iFileCacheMinSize value invalid, clamped to {}", iFileCacheMinSize);
+    }
+    inipp::get_value(ini.sections["File Cache"], "MemoryMap", bFileCacheMemoryMap);
+    spdlog::info("Config Parse: bFileCache: {}", bFileCache);
+    spdlog::info("Config Parse: iFileCacheSize: {}", iFileCacheSize);
+    spdlog::info("Config Parse: iFileReadAhead: {}", iFileReadAhead);
+    spdlog::info("Config Parse: iFileCacheMinSize: {}", iFileCacheMinSize);
+    spdlog::info("Config Parse: bFileCacheMemoryMap: {}", bFileCacheMemoryMap);
+
+    inipp::get_value(ini.sections["Live Resize"], "Enabled", bLiveResize);
+    spdlog::info("Config Parse: bLiveResize: {}", bLiveResize);
+
+    inipp::get_value(ini.sections["Metrics"], "Enabled", bMetrics);
+    spdlog::info("Config Parse: bMetrics: {}", bMetrics);
+
     spdlog::info("----------");
 
     // Grab desktop resolution
@@ -254,12 +476,97 @@ void Configuration()
     CalculateAspectRatio(true);
 }
 
+// Raw input coalescing
+// The first WM_INPUT of a batch drains everything queued behind it with one GetRawInputBuffer call. The game pumps its
+// messages once per frame, so that is one drain per frame. Consecutive relative mouse moves from the same device are
+// merged, then every record is handed to the game's window procedure in order under the original message's handle,
+// and GetRawInputData answers from the drained copy.
+SafetyHookInline GetRawInputData_sh{};
+HRAWINPUT hDeliveredRawInput = nullptr;
+const RAWINPUT* pDeliveredRawInput = nullptr;
+alignas(8) uint8_t rawInputBuffer[0x10000];
+bool bDeliveringRawInput = false;
+uint64_t iCoalescedMessages = 0;
+
+UINT WINAPI GetRawInputData_hk(HRAWINPUT hRawInput, UINT uiCommand, LPVOID pData, PUINT pcbSize, UINT cbSizeHeader) {
+    Timeline::Scope scope("Input: GetRawInputData");
+    if (!pDeliveredRawInput || hRawInput != hDeliveredRawInput || !pcbSize || cbSizeHeader != sizeof(RAWINPUTHEADER) || (uiCommand != RID_INPUT && uiCommand != RID_HEADER))
+        return GetRawInputData_sh.stdcall<UINT>(hRawInput, uiCommand, pData, pcbSize, cbSizeHeader);
+
+    UINT size = uiCommand == RID_HEADER ? (UINT)sizeof(RAWINPUTHEADER) : pDeliveredRawInput->header.dwSize;
+    if (!pData) {
+        *pcbSize = size;
+        return 0;
+    }
+    if (*pcbSize < size) {
+        SetLastError(ERROR_INSUFFICIENT_BUFFER);
+        return (UINT)-1;
+    }
+    memcpy(pData, pDeliveredRawInput, size);
+    return size;
+}
+
+// Only relative moves without button or wheel changes are safe to merge
+bool IsRawMouseMotion(const RAWINPUT& raw) {
+    return raw.header.dwType == RIM_TYPEMOUSE && !(raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE) && raw.data.mouse.usButtonFlags == 0;
+}
+
 WNDPROC OldWndProc;
 LRESULT __stdcall NewWndProc(HWND window, UINT message_type, WPARAM w_param, LPARAM l_param) {
     switch (message_type) {
     case WM_CLOSE:
         // No exit/ALT+F4 handler bullshit.
         return DefWindowProc(window, message_type, w_param, l_param);
+    case WM_INPUT:
+        // A nested WM_INPUT (the game pumping messages from its handler) must not drain into the buffer the outer
+        // message is still walking, so it goes through uncoalesced
+        if (bCoalesceInput && GetRawInputData_sh && !bDeliveringRawInput) {
+            // This message's own record comes first, anything bigger than a RAWINPUT (HID reports) goes through untouched
+            RAWINPUT current{};
+            UINT size = sizeof(current);
+            if (GetRawInputData_sh.stdcall<UINT>((HRAWINPUT)l_param, RID_INPUT, &current, &size, (UINT)sizeof(RAWINPUTHEADER)) == (UINT)-1)
+                break;
+
+            size = sizeof(rawInputBuffer);
+            UINT iCount = GetRawInputBuffer(reinterpret_cast<RAWINPUT*>(rawInputBuffer), &size, (UINT)sizeof(RAWINPUTHEADER));
+            if (iCount == (UINT)-1)
+                iCount = 0;
+
+            bDeliveringRawInput = true;
+            hDeliveredRawInput = (HRAWINPUT)l_param;
+            LRESULT result = 0;
+            auto deliver = [&](RAWINPUT* raw) {
+                pDeliveredRawInput = raw;
+                result = CallWindowProc(OldWndProc, window, message_type, w_param, l_param);
+            };
+
+            // Keyboard and button events are never merged, so they keep their order relative to motion
+            RAWINPUT* motion = IsRawMouseMotion(current) ? &current : nullptr;
+            if (!motion)
+                deliver(&current);
+            RAWINPUT* raw = reinterpret_cast<RAWINPUT*>(rawInputBuffer);
+            for (UINT i = 0; i < iCount; i++, raw = NEXTRAWINPUTBLOCK(raw)) {
+                if (motion && IsRawMouseMotion(*raw) && raw->header.hDevice == motion->header.hDevice) {
+                    motion->data.mouse.lLastX += raw->data.mouse.lLastX;
+                    motion->data.mouse.lLastY += raw->data.mouse.lLastY;
+                    iCoalescedMessages++;
+                    continue;
+                }
+                if (motion)
+                    deliver(motion);
+                motion = IsRawMouseMotion(*raw) ? raw : nullptr;
+                if (!motion)
+                    deliver(raw);
+            }
+            if (motion)
+                deliver(motion);
+
+            hDeliveredRawInput = nullptr;
+            pDeliveredRawInput = nullptr;
+            bDeliveringRawInput = false;
+            return result;
+        }
+        break;
     }
 
     return CallWindowProc(OldWndProc, window, message_type, w_param, l_param);
@@ -314,99 +621,834 @@ void WindowManagement()
         else {
             spdlog::error("Game Window: Failed to get function address for SetWindowLongA.");
         }
+
+        if (bCoalesceInput) {
+            FARPROC GetRawInputData_fn = GetProcAddress(user32Module, "GetRawInputData");
+            if (GetRawInputData_fn) {
+                GetRawInputData_sh = safetyhook::create_inline(GetRawInputData_fn, reinterpret_cast<void*>(GetRawInputData_hk));
+                spdlog::info("Input Coalescing: Hooked GetRawInputData.");
+            }
+            else {
+                spdlog::error("Input Coalescing: Failed to get function address for GetRawInputData.");
+            }
+        }
     }
     else {
         spdlog::error("Game Window: Failed to get module handle for user32.dll.");
     }
 }
 
+// Heap allocator
+// Only allocations made by the game image on the process heap are redirected. Frees, reallocs and size queries
+// check ownership first, so blocks from before the redirect or from other modules go back to the original heap.
+SafetyHookInline RtlAllocateHeap_sh{};
+SafetyHookInline RtlFreeHeap_sh{};
+SafetyHookInline RtlReAllocateHeap_sh{};
+SafetyHookInline RtlSizeHeap_sh{};
+SafetyHookInline malloc_sh{};
+SafetyHookInline calloc_sh{};
+SafetyHookInline realloc_sh{};
+SafetyHookInline free_sh{};
+SafetyHookInline msize_sh{};
+HANDLE hProcessHeap;
+uintptr_t iGameStart;
+uintptr_t iGameEnd;
+
+inline bool IsGameCaller(void* returnAddress)
+{
+    return (uintptr_t)returnAddress >= iGameStart && (uintptr_t)returnAddress < iGameEnd;
+}
+
+PVOID NTAPI RtlAllocateHeap_hk(PVOID hHeap, ULONG dwFlags, SIZE_T dwBytes)
+{
+    if (hHeap == hProcessHeap && IsGameCaller(_ReturnAddress())) {
+        if (void* p = HeapAllocator::Allocate(dwBytes)) {
+            if (dwFlags & HEAP_ZERO_MEMORY)
+                memset(p, 0, dwBytes);
+            return p;
+        }
+    }
+    return RtlAllocateHeap_sh.stdcall<PVOID>(hHeap, dwFlags, dwBytes);
+}
+
+BOOLEAN NTAPI RtlFreeHeap_hk(PVOID hHeap, ULONG dwFlags, PVOID lpMem)
+{
+    if (HeapAllocator::Owns(lpMem)) {
+        HeapAllocator::Free(lpMem);
+        return TRUE;
+    }
+    if (lpMem && IsGameCaller(_ReturnAddress()))
+        HeapAllocator::stats.iForeignFrees.fetch_add(1, std::memory_order_relaxed);
+    return RtlFreeHeap_sh.stdcall<BOOLEAN>(hHeap, dwFlags, lpMem);
+}
+
+PVOID NTAPI RtlReAllocateHeap_hk(PVOID hHeap, ULONG dwFlags, PVOID lpMem, SIZE_T dwBytes)
+{
+    if (!HeapAllocator::Owns(lpMem))
+        return RtlReAllocateHeap_sh.stdcall<PVOID>(hHeap, dwFlags, lpMem, dwBytes);
+
+    bool bZero = dwFlags & HEAP_ZERO_MEMORY;
+    if (dwFlags & HEAP_REALLOC_IN_PLACE_ONLY)
+        return HeapAllocator::Resize(lpMem, dwBytes, bZero) ? lpMem : NULL;
+
+    if (void* p = HeapAllocator::Reallocate(lpMem, dwBytes, bZero))
+        return p;
+
+    // Grew past the largest size class, move it to the original heap (which zeroes the new block with the same flags)
+    void* p = RtlAllocateHeap_sh.stdcall<PVOID>(hHeap, dwFlags, dwBytes);
+    if (!p)
+        return NULL;
+    memcpy(p, lpMem, HeapAllocator::Size(lpMem));
+    HeapAllocator::Free(lpMem);
+    return p;
+}
+
+SIZE_T NTAPI RtlSizeHeap_hk(PVOID hHeap, ULONG dwFlags, PVOID lpMem)
+{
+    if (HeapAllocator::Owns(lpMem))
+        return HeapAllocator::Size(lpMem);
+    return RtlSizeHeap_sh.stdcall<SIZE_T>(hHeap, dwFlags, lpMem);
+}
+
+void* malloc_hk(size_t iSize)
+{
+    if (IsGameCaller(_ReturnAddress())) {
+        if (void* p = HeapAllocator::Allocate(iSize))
+            return p;
+    }
+    return malloc_sh.call<void*>(iSize);
+}
+
+void* calloc_hk(size_t iCount, size_t iSize)
+{
+    if (IsGameCaller(_ReturnAddress()) && (iSize == 0 || iCount <= HeapAllocator::iMaxSize / iSize)) {
+        if (void* p = HeapAllocator::Allocate(iCount * iSize)) {
+            memset(p, 0, iCount * iSize);
+            return p;
+        }
+    }
+    return calloc_sh.call<void*>(iCount, iSize);
+}
+
+void free_hk(void* p)
+{
+    if (HeapAllocator::Owns(p)) {
+        HeapAllocator::Free(p);
+        return;
+    }
+    if (p && IsGameCaller(_ReturnAddress()))
+        HeapAllocator::stats.iForeignFrees.fetch_add(1, std::memory_order_relaxed);
+    free_sh.call(p);
+}
+
+void* realloc_hk(void* p, size_t iSize)
+{
+    if (!HeapAllocator::Owns(p)) {
+        if (!p && IsGameCaller(_ReturnAddress())) {
+            if (void* result = HeapAllocator::Allocate(iSize))
+                return result;
+        }
+        return realloc_sh.call<void*>(p, iSize);
+    }
+
+    // realloc(p, 0) frees
+    if (iSize == 0) {
+        HeapAllocator::Free(p);
+        return nullptr;
+    }
+
+    if (void* result = HeapAllocator::Reallocate(p, iSize))
+        return result;
+
+    void* result = malloc_sh.call<void*>(iSize);
+    if (!result)
+        return nullptr;
+    memcpy(result, p, HeapAllocator::Size(p));
+    HeapAllocator::Free(p);
+    return result;
+}
+
+size_t msize_hk(void* p)
+{
+    if (HeapAllocator::Owns(p))
+        return HeapAllocator::Size(p);
+    return msize_sh.call<size_t>(p);
+}
+
+DWORD __stdcall HeapStatsThread(void*)
+{
+    while (true) {
+        Sleep(iHeapStatsInterval * 1000);
+
+        auto& stats = HeapAllocator::stats;
+        spdlog::info("Heap Allocator: {} allocations, {} frees, {} fallbacks, {} foreign, {} refills, {} releases, {} KB committed.",
+            stats.iAllocations.load(), stats.iFrees.load(), stats.iFallbacks.load(), stats.iForeignFrees.load(),
+            stats.iRefills.load(), stats.iReleases.load(), HeapAllocator::CommittedBytes() / 1024);
+    }
+    return true;
+}
+
+void HeapRedirect()
+{
+    if (!bHeapAllocator)
+        return;
+
+    if (!HeapAllocator::Initialize()) {
+        spdlog::error("Heap Allocator: Failed to reserve {} MB.", HeapAllocator::iReserveSize / (1024 * 1024));
+        return;
+    }
+
+    hProcessHeap = GetProcessHeap();
+    iGameStart = (uintptr_t)baseModule;
+    iGameEnd = iGameStart + Memory::ModuleSize(baseModule);
+
+    HMODULE ntdllModule = GetModuleHandleW(L"ntdll.dll");
+    if (ntdllModule) {
+        FARPROC RtlAllocateHeap_fn = GetProcAddress(ntdllModule, "RtlAllocateHeap");
+        FARPROC RtlFreeHeap_fn = GetProcAddress(ntdllModule, "RtlFreeHeap");
+        FARPROC RtlReAllocateHeap_fn = GetProcAddress(ntdllModule, "RtlReAllocateHeap");
+        FARPROC RtlSizeHeap_fn = GetProcAddress(ntdllModule, "RtlSizeHeap");
+        if (RtlAllocateHeap_fn && RtlFreeHeap_fn && RtlReAllocateHeap_fn && RtlSizeHeap_fn) {
+            // Ownership checks go in before anything can hand out an owned block
+            RtlSizeHeap_sh = safetyhook::create_inline(RtlSizeHeap_fn, reinterpret_cast<void*>(RtlSizeHeap_hk));
+            RtlFreeHeap_sh = safetyhook::create_inline(RtlFreeHeap_fn, reinterpret_cast<void*>(RtlFreeHeap_hk));
+            RtlReAllocateHeap_sh = safetyhook::create_inline(RtlReAllocateHeap_fn, reinterpret_cast<void*>(RtlReAllocateHeap_hk));
+            RtlAllocateHeap_sh = safetyhook::create_inline(RtlAllocateHeap_fn, reinterpret_cast<void*>(RtlAllocateHeap_hk));
+            spdlog::info("Heap Allocator: Hooked RtlAllocateHeap, RtlFreeHeap, RtlReAllocateHeap and RtlSizeHeap.");
+        }
+        else {
+            spdlog::error("Heap Allocator: Failed to get function addresses for the heap functions.");
+        }
+    }
+    else {
+        spdlog::error("Heap Allocator: Failed to get module handle for ntdll.dll.");
+    }
+
+    // Only present if the game uses the dynamic CRT
+    HMODULE ucrtModule = GetModuleHandleW(L"ucrtbase.dll");
+    if (ucrtModule) {
+        FARPROC malloc_fn = GetProcAddress(ucrtModule, "malloc");
+        FARPROC calloc_fn = GetProcAddress(ucrtModule, "calloc");
+        FARPROC realloc_fn = GetProcAddress(ucrtModule, "realloc");
+        FARPROC free_fn = GetProcAddress(ucrtModule, "free");
+        FARPROC msize_fn = GetProcAddress(ucrtModule, "_msize");
+        if (malloc_fn && calloc_fn && realloc_fn && free_fn && msize_fn) {
+            msize_sh = safetyhook::create_inline(msize_fn, reinterpret_cast<void*>(msize_hk));
+            free_sh = safetyhook::create_inline(free_fn, reinterpret_cast<void*>(free_hk));
+            realloc_sh = safetyhook::create_inline(realloc_fn, reinterpret_cast<void*>(realloc_hk));
+            calloc_sh = safetyhook::create_inline(calloc_fn, reinterpret_cast<void*>(calloc_hk));
+            malloc_sh = safetyhook::create_inline(malloc_fn, reinterpret_cast<void*>(malloc_hk));
+            spdlog::info("Heap Allocator: Hooked ucrtbase malloc, calloc, realloc, free and _msize.");
+        }
+        else {
+            spdlog::error("Heap Allocator: Failed to get function addresses for the CRT heap functions.");
+        }
+    }
+
+    if (iHeapStatsInterval > 0) {
+        HANDLE heapStatsHandle = CreateThread(NULL, 0, HeapStatsThread, 0, NULL, 0);
+        if (heapStatsHandle) {
+            CloseHandle(heapStatsHandle);
+        }
+    }
+}
+
+// File cache
+// Archives are recognised when they are opened: read-only, synchronous, buffered and at least MinFileSize. Reads on
+// those handles go through FileCache, which either serves them or hands them back to the original ReadFile.
+SafetyHookInline CreateFileW_sh{};
+SafetyHookInline ReadFile_sh{};
+SafetyHookInline CloseHandle_sh{};
+std::shared_mutex fileStreamsMutex;
+std::unordered_map<HANDLE, std::unique_ptr<FileCache::Stream>> fileStreams;
+std::atomic<size_t> iFileStreamCount = 0;
+
+FileCache::Stream* FindFileStream(HANDLE hFile)
+{
+    if (iFileStreamCount.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+
+    std::shared_lock lock(fileStreamsMutex);
+    auto it = fileStreams.find(hFile);
+    return it != fileStreams.end() ? it->second.get() : nullptr;
+}
+
+void TrackFile(HANDLE hFile)
+{
+    LARGE_INTEGER size{};
+    if (GetFileType(hFile) != FILE_TYPE_DISK || !GetFileSizeEx(hFile, &size) || size.QuadPart < (LONGLONG)iFileCacheMinSize * 1024 * 1024)
+        return;
+
+    wchar_t sPath[MAX_PATH * 2];
+    DWORD iLength = GetFinalPathNameByHandleW(hFile, sPath, (DWORD)std::size(sPath), FILE_NAME_NORMALIZED);
+    if (iLength == 0 || iLength >= std::size(sPath))
+        return;
+
+    // Our own handle, so read-ahead never moves the game's file pointer
+    HANDLE hCacheFile = CreateFileW_sh.stdcall<HANDLE>(sPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hCacheFile == INVALID_HANDLE_VALUE)
+        return;
+
+    std::string sPathUTF8(WideCharToMultiByte(CP_UTF8, 0, sPath, (int)iLength, nullptr, 0, nullptr, nullptr), '\0');
+    WideCharToMultiByte(CP_UTF8, 0, sPath, (int)iLength, sPathUTF8.data(), (int)sPathUTF8.size(), nullptr, nullptr);
+    auto stream = std::make_unique<FileCache::Stream>();
+    stream->file = FileCache::Open(sPathUTF8, hCacheFile, (uint64_t)size.QuadPart);
+    if (stream->file->iOpenCount == 1)
+        spdlog::info("File Cache: Tracking {} ({} MB{}).", sPathUTF8, size.QuadPart / (1024 * 1024), stream->file->view ? ", mapped" : "");
+
+    std::unique_lock lock(fileStreamsMutex);
+    fileStreams[hFile] = std::move(stream);
+    iFileStreamCount = fileStreams.size();
+}
+
+HANDLE WINAPI CreateFileW_hk(LPCWSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+    HANDLE hFile = CreateFileW_sh.stdcall<HANDLE>(lpFileName, dwDesiredAccess, dwShareMode, lpSecurityAttributes, dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
+    if (hFile != INVALID_HANDLE_VALUE && dwCreationDisposition == OPEN_EXISTING
+        && (dwDesiredAccess & (GENERIC_READ | FILE_READ_DATA))
+        && !(dwDesiredAccess & (GENERIC_WRITE | GENERIC_ALL | FILE_WRITE_DATA | FILE_APPEND_DATA))
+        && !(dwFlagsAndAttributes & (FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING))) {
+        TrackFile(hFile);
+    }
+    return hFile;
+}
+
+BOOL WINAPI ReadFile_hk(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped)
+{
+    if (FileCache::Stream* stream = FindFileStream(hFile)) {
+        uint64_t iOffset = 0;
+        LARGE_INTEGER position{};
+        if (lpOverlapped)
+            iOffset = ((uint64_t)lpOverlapped->OffsetHigh << 32) | lpOverlapped->Offset;
+        else if (SetFilePointerEx(hFile, position, &position, FILE_CURRENT))
+            iOffset = (uint64_t)position.QuadPart;
+        else
+            return ReadFile_sh.stdcall<BOOL>(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, lpOverlapped);
+
+        size_t iRead = 0;
+        if (lpBuffer && FileCache::Read(*stream, iOffset, lpBuffer, nNumberOfBytesToRead, iRead)) {
+            // Leave the file pointer where the real read would have
+            position.QuadPart = (LONGLONG)(iOffset + iRead);
+            SetFilePointerEx(hFile, position, nullptr, FILE_BEGIN);
+            if (lpNumberOfBytesRead)
+                *lpNumberOfBytesRead = (DWORD)iRead;
+            if (lpOverlapped) {
+                lpOverlapped->Internal = 0;
+                lpOverlapped->InternalHigh = iRead;
+                if (lpOverlapped->hEvent)
+                    SetEvent(lpOverlapped->hEvent);
+            }
+            return TRUE;
+        }
+    }
+    return ReadFile_sh.stdcall<BOOL>(hFile, lpBuffer, nNumberOfBytesToRead, lpNumberOfBytesRead, lpOverlapped);
+}
+
+BOOL WINAPI CloseHandle_hk(HANDLE hObject)
+{
+    if (iFileStreamCount.load(std::memory_order_relaxed) != 0) {
+        std::unique_ptr<FileCache::Stream> stream{};
+        {
+            std::unique_lock lock(fileStreamsMutex);
+            if (auto it = fileStreams.find(hObject); it != fileStreams.end()) {
+                stream = std::move(it->second);
+                fileStreams.erase(it);
+                iFileStreamCount = fileStreams.size();
+            }
+        }
+
+        if (stream) {
+            if (auto file = FileCache::Close(stream->file)) {
+                auto& stats = file->stats;
+                uint64_t iReads = stats.iReads.load();
+                spdlog::info("File Cache: Closed {}: {} reads, {:.1f}% hits, {} misses, {} passed through, {} MB served, {} MB read ahead. {} MB cached.",
+                    file->sPath, iReads, iReads ? 100.0 * (double)stats.iHits.load() / (double)iReads : 0.0, stats.iMisses.load(), stats.iPassthrough.load(),
+                    stats.iBytesServed.load() / (1024 * 1024), stats.iReadAheadBytes.load() / (1024 * 1024), FileCache::CachedBytes() / (1024 * 1024));
+            }
+        }
+    }
+    return CloseHandle_sh.stdcall<BOOL>(hObject);
+}
+
+void FileCaching()
+{
+    if (!bFileCache)
+        return;
+
+    FileCache::Settings settings{};
+    settings.iBudget = (size_t)iFileCacheSize * 1024 * 1024;
+    settings.iReadAhead = (size_t)iFileReadAhead * 1024 * 1024;
+    settings.bMemoryMap = bFileCacheMemoryMap;
+    FileCache::Initialize(settings);
+
+    HMODULE kernel32Module = GetModuleHandleW(L"kernel32.dll");
+    if (kernel32Module) {
+        FARPROC CreateFileW_fn = GetProcAddress(kernel32Module, "CreateFileW");
+        FARPROC ReadFile_fn = GetProcAddress(kernel32Module, "ReadFile");
+        FARPROC CloseHandle_fn = GetProcAddress(kernel32Module, "CloseHandle");
+        if (CreateFileW_fn && ReadFile_fn && CloseHandle_fn) {
+            CloseHandle_sh = safetyhook::create_inline(CloseHandle_fn, reinterpret_cast<void*>(CloseHandle_hk));
+            ReadFile_sh = safetyhook::create_inline(ReadFile_fn, reinterpret_cast<void*>(ReadFile_hk));
+            CreateFileW_sh = safetyhook::create_inline(CreateFileW_fn, reinterpret_cast<void*>(CreateFileW_hk));
+            spdlog::info("File Cache: Hooked CreateFileW, ReadFile and CloseHandle.");
+        }
+        else {
+            spdlog::error("File Cache: Failed to get function addresses for the file functions.");
+        }
+    }
+    else {
+        spdlog::error("File Cache: Failed to get module handle for kernel32.dll.");
+    }
+}
+
+IDXGISwapChain* pFlipSwapChain = nullptr;
+bool bFlipSwapChainTearing = false;
+
+SafetyHookInline Present_sh{};
+HRESULT __stdcall Present_hk(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags) {
+    if (pSwapChain == pFlipSwapChain)
+        Flags = Swapchain::TranslatePresentFlags(SyncInterval, Flags, bFlipSwapChainTearing);
+
+    return Present_sh.stdcall<HRESULT>(pSwapChain, SyncInterval, Flags);
+}
+
+// Live resize follows the back buffer, which is what the game renders at. The window's client size isn't, it differs
+// under DPI virtualization and while the game pins its own resolution.
+void RequestBackBufferSize(IDXGISwapChain* pSwapChain)
+{
+    DXGI_SWAP_CHAIN_DESC desc{};
+    if (bLiveResize && SUCCEEDED(pSwapChain->GetDesc(&desc)))
+        Layout::Request((int)desc.BufferDesc.Width, (int)desc.BufferDesc.Height);
+}
+
+SafetyHookInline ResizeBuffers_sh{};
+HRESULT __stdcall ResizeBuffers_hk(IDXGISwapChain* pSwapChain, UINT BufferCount, UINT Width, UINT Height, DXGI_FORMAT NewFormat, UINT SwapChainFlags) {
+    if (pSwapChain == pFlipSwapChain)
+        Swapchain::TranslateResizeBuffers(BufferCount, SwapChainFlags, (UINT)iFlipModelBufferCount, bFlipSwapChainTearing);
+
+    HRESULT result = ResizeBuffers_sh.stdcall<HRESULT>(pSwapChain, BufferCount, Width, Height, NewFormat, SwapChainFlags);
+    // Width and height can be 0 (use the window size), so the real size comes from the swapchain
+    if (SUCCEEDED(result))
+        RequestBackBufferSize(pSwapChain);
+    return result;
+}
+
+// Present and ResizeBuffers are shared by every swapchain, so hooking them once is enough
+void HookSwapChain(IDXGISwapChain* pSwapChain)
+{
+    void** vtable = *reinterpret_cast<void***>(pSwapChain);
+    if (!Present_sh && pSwapChain == pFlipSwapChain)
+        Present_sh = safetyhook::create_inline(vtable[8], reinterpret_cast<void*>(Present_hk));
+    if (!ResizeBuffers_sh)
+        ResizeBuffers_sh = safetyhook::create_inline(vtable[13], reinterpret_cast<void*>(ResizeBuffers_hk));
+    RequestBackBufferSize(pSwapChain);
+}
+
+SafetyHookInline CreateSwapChain_sh{};
+HRESULT __stdcall CreateSwapChain_hk(IDXGIFactory* pFactory, IUnknown* pDevice, DXGI_SWAP_CHAIN_DESC* pDesc, IDXGISwapChain** ppSwapChain) {
+    if (bFlipModel && bBorderlessMode && pDesc && ppSwapChain) {
+        DXGI_SWAP_CHAIN_DESC desc = *pDesc;
+        if (Swapchain::UpgradeDesc(desc, (UINT)iFlipModelBufferCount, bFlipModelTearing)) {
+            HRESULT result = CreateSwapChain_sh.stdcall<HRESULT>(pFactory, pDevice, &desc, ppSwapChain);
+            if (SUCCEEDED(result)) {
+                spdlog::info("Flip Model: Created flip model swapchain. Buffers = {}, Tearing = {}", desc.BufferCount, bFlipModelTearing);
+                pFlipSwapChain = *ppSwapChain;
+                bFlipSwapChainTearing = bFlipModelTearing;
+                HookSwapChain(pFlipSwapChain);
+                return result;
+            }
+            spdlog::error("Flip Model: Failed to create flip model swapchain (0x{:x}), falling back to the game's swapchain.", (unsigned long)result);
+        }
+        else {
+            spdlog::warn("Flip Model: Swapchain description is not flip model compatible, leaving it unchanged.");
+        }
+    }
+
+    HRESULT result = CreateSwapChain_sh.stdcall<HRESULT>(pFactory, pDevice, pDesc, ppSwapChain);
+    if (bLiveResize && SUCCEEDED(result) && ppSwapChain && *ppSwapChain)
+        HookSwapChain(*ppSwapChain);
+    return result;
+}
+
+// The CreateSwapChain hook serves both the flip model upgrade and live resize
+void FlipModel()
+{
+    if ((bFlipModel && bBorderlessMode) || bLiveResize) {
+        HMODULE dxgiModule = LoadLibraryW(L"dxgi.dll");
+        if (!dxgiModule) {
+            spdlog::error("Flip Model: Failed to load dxgi.dll.");
+            return;
+        }
+
+        auto CreateDXGIFactory1_fn = reinterpret_cast<decltype(&CreateDXGIFactory1)>(GetProcAddress(dxgiModule, "CreateDXGIFactory1"));
+        IDXGIFactory1* pFactory = nullptr;
+        if (!CreateDXGIFactory1_fn || FAILED(CreateDXGIFactory1_fn(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&pFactory)))) {
+            spdlog::error("Flip Model: Failed to create DXGI factory.");
+            return;
+        }
+
+        // Tearing needs Windows 10 and a driver that supports it
+        if (bFlipModel && bBorderlessMode && bFlipModelTearing) {
+            BOOL bTearingSupported = FALSE;
+            IDXGIFactory5* pFactory5 = nullptr;
+            if (SUCCEEDED(pFactory->QueryInterface(__uuidof(IDXGIFactory5), reinterpret_cast<void**>(&pFactory5)))) {
+                if (FAILED(pFactory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &bTearingSupported, sizeof(bTearingSupported))))
+                    bTearingSupported = FALSE;
+                pFactory5->Release();
+            }
+
+            if (!bTearingSupported) {
+                bFlipModelTearing = false;
+                spdlog::warn("Flip Model: Tearing is not supported on this system, disabled AllowTearing.");
+            }
+        }
+
+        // IDXGIFactory::CreateSwapChain
+        void** vtable = *reinterpret_cast<void***>(pFactory);
+        CreateSwapChain_sh = safetyhook::create_inline(vtable[10], reinterpret_cast<void*>(CreateSwapChain_hk));
+        pFactory->Release();
+
+        if (CreateSwapChain_sh)
+            spdlog::info("Flip Model: Hooked IDXGIFactory::CreateSwapChain.");
+        else
+            spdlog::error("Flip Model: Failed to hook IDXGIFactory::CreateSwapChain.");
+    }
+}
+
+void LoadScanCache()
+{
+    if (!bScanCache)
+        return;
+
+    std::ifstream cacheFile(sThisModulePath / sScanCacheFile);
+    ScanCache::Cache cache{};
+    if (!cacheFile || !ScanCache::Read(cacheFile, cache)) {
+        spdlog::info("Scan Cache: No cache found, signatures will be scanned.");
+    }
+    else if (cache.iTimestamp != Memory::ModuleTimestamp(baseModule) || cache.iImageSize != Memory::ModuleSize(baseModule)) {
+        spdlog::info("Scan Cache: Cache is for a different game version, signatures will be scanned.");
+    }
+    else {
+        scanCache = cache;
+        spdlog::info("Scan Cache: Loaded {} cached signature results.", scanCache.results.size());
+        return;
+    }
+
+    scanCache = { Memory::ModuleTimestamp(baseModule), Memory::ModuleSize(baseModule) };
+}
+
+void SaveScanCache()
+{
+    if (!bScanCache || !bScanCacheDirty)
+        return;
+
+    std::ofstream cacheFile(sThisModulePath / sScanCacheFile, std::ios::trunc);
+    if (cacheFile) {
+        ScanCache::Write(cacheFile, scanCache);
+        spdlog::info("Scan Cache: Saved {} signature results to {}", scanCache.results.size(), (sThisModulePath / sScanCacheFile).string());
+    }
+    else {
+        spdlog::error("Scan Cache: Failed to write {}", (sThisModulePath / sScanCacheFile).string());
+    }
+}
+
+void LoadPrePatch()
+{
+    std::ifstream manifestFile(sThisModulePath / sPrePatchFile);
+    PrePatch::Manifest manifest{};
+    if (!manifestFile)
+        return;
+    if (!PrePatch::Read(manifestFile, manifest)) {
+        spdlog::error("Pre-Patch: Failed to parse {}, patching at runtime.", (sThisModulePath / sPrePatchFile).string());
+        return;
+    }
+    if (manifest.iTimestamp != Memory::ModuleTimestamp(baseModule) || manifest.iImageSize != Memory::ModuleSize(baseModule)) {
+        spdlog::info("Pre-Patch: Manifest is for a different game version, patching at runtime.");
+        return;
+    }
+
+    // Only keep patches that are really in the loaded image, an unpatched executable next to a manifest is fine
+    uint32_t iImageSize = Memory::ModuleSize(baseModule);
+    for (const PrePatch::Patch& patch : manifest.patches) {
+        uint8_t* address = reinterpret_cast<uint8_t*>(baseModule) + patch.iRva;
+        if ((uint64_t)patch.iRva + patch.patched.size() > iImageSize || memcmp(address, patch.patched.data(), patch.patched.size()) != 0)
+            continue;
+
+        // Baked into the file but switched off in the ini, put the game's bytes back
+        bool bEnabled = (patch.sFeature == "Resolution" && bCustomRes) || (patch.sFeature == "HUD" && bFixHUD);
+        if (!bEnabled) {
+            Memory::PatchBytes((uintptr_t)address, reinterpret_cast<const char*>(patch.original.data()), static_cast<unsigned int>(patch.original.size()));
+            spdlog::info("Pre-Patch: {} is disabled, restored original bytes at {:s}+{:x}", patch.sName, sExeName.c_str(), patch.iRva);
+            continue;
+        }
+        prePatch.patches.push_back(patch);
+    }
+    spdlog::info("Pre-Patch: {} of {} baked patches present in {:s}.", prePatch.patches.size(), manifest.patches.size(), sExeName.c_str());
+}
+
+// True when the executable already has exactly these bytes baked in for the named patch
+bool IsPrePatched(const char* sName, const void* bytes, size_t iSize)
+{
+    const PrePatch::Patch* patch = prePatch.Find(sName);
+    if (!patch || patch->patched.size() != iSize)
+        return false;
+
+    if (memcmp(reinterpret_cast<uint8_t*>(baseModule) + patch->iRva, bytes, iSize) != 0) {
+        spdlog::warn("Pre-Patch: {} was baked with different settings, patching at runtime.", sName);
+        return false;
+    }
+    return true;
+}
+
+void SymbolMapExport()
+{
+    if (!bSymbolMap)
+        return;
+
+    // Inline hooks on system functions have no signature to be named after
+    const std::pair<const char*, const SafetyHookInline*> inlineHooks[] = {
+        { "Input.GetRawInputData", &GetRawInputData_sh }, { "Window.SetWindowLongA", &SetWindowLongA_sh },
+        { "Heap.RtlAllocateHeap", &RtlAllocateHeap_sh }, { "Heap.RtlFreeHeap", &RtlFreeHeap_sh },
+        { "Heap.RtlReAllocateHeap", &RtlReAllocateHeap_sh }, { "Heap.RtlSizeHeap", &RtlSizeHeap_sh },
+        { "Heap.malloc", &malloc_sh }, { "Heap.calloc", &calloc_sh }, { "Heap.realloc", &realloc_sh }, { "Heap.free", &free_sh }, { "Heap.msize", &msize_sh },
+        { "FileCache.CreateFileW", &CreateFileW_sh }, { "FileCache.ReadFile", &ReadFile_sh }, { "FileCache.CloseHandle", &CloseHandle_sh },
+        { "FlipModel.Present", &Present_sh }, { "FlipModel.ResizeBuffers", &ResizeBuffers_sh }, { "FlipModel.CreateSwapChain", &CreateSwapChain_sh },
+    };
+    for (const auto& [sName, hook] : inlineHooks)
+        SymbolMap::AddInline(sName, *hook);
+
+    auto symbols = SymbolMap::Build(baseModule, sExeName, sFixName);
+    std::filesystem::path perfMapPath = sThisModulePath / (sFixName + "_perf.map");
+    std::filesystem::path csvPath = sThisModulePath / (sFixName + "_symbols.csv");
+    std::ofstream perfMapFile(perfMapPath, std::ios::trunc);
+    std::ofstream csvFile(csvPath, std::ios::trunc);
+    if (!perfMapFile || !csvFile) {
+        spdlog::error("Symbol Map: Failed to write {} and {}", perfMapPath.string(), csvPath.string());
+        return;
+    }
+
+    SymbolMap::WritePerfMap(perfMapFile, symbols);
+    SymbolMap::WriteCsv(csvFile, symbols, baseModule);
+    spdlog::info("Symbol Map: Wrote {} symbols to {} and {}", symbols.size(), perfMapPath.string(), csvPath.string());
+    spdlog::info("Symbol Map: For perf under Wine/Proton, copy the map to /tmp/perf-<pid>.map using the Linux pid of the game.");
+}
+
+void ReserveHookArena()
+{
+    if (!bHookArena)
+        return;
+
+    // One allocation granularity block holds every stub and trampoline the fix installs
+    if (HookArena::Reserve(baseModule, 0x10000))
+        spdlog::info("Hook Arena: Reserved {:x} bytes at {:x}", HookArena::iSize, HookArena::iBase);
+    else
+        spdlog::error("Hook Arena: Failed to reserve memory near {:s}, using the default allocator.", sExeName.c_str());
+}
+
+void HookArenaUsage()
+{
+    if (HookArena::iBase)
+        spdlog::info("Hook Arena: {:x} of {:x} bytes used.", HookArena::Used(), HookArena::iSize);
+}
+
+// Diagnostics for signatures resolved with GetAbsolute() that no longer match, e.g. after a game update changed the
+// code around the instruction. Every instruction in the cross-reference index is a candidate, placed so its
+// RIP-relative operand lands on iAbsoluteOffset, and the one matching most of the pattern's concrete bytes is logged
+// if it is the only best and matches at least 3/4 of them. Nothing is patched at a candidate, a partial match can put
+// the fix's writes and hook offsets anywhere, so it is only a starting point for tools/siggen or a manual fix. The
+// index is only built here, so launches where every scan succeeds never pay for decoding the image.
+void ReportSignatureCandidate(const Signatures::Signature& signature)
+{
+    static bool bLogged = false;
+    auto& index = Xref::Get(baseModule);
+    if (!bLogged) {
+        spdlog::info("Cross References: Indexed {} references.", index.Size());
+        bLogged = true;
+    }
+
+    auto pattern = Signatures::ParsePattern(signature.sPattern);
+    size_t iConcrete = std::count_if(pattern.begin(), pattern.end(), [](int iByte) { return iByte != -1; });
+    uint8_t* base = reinterpret_cast<uint8_t*>(baseModule);
+    int64_t iImageSize = Memory::ModuleSize(baseModule);
+
+    uint8_t* best = nullptr;
+    size_t iBestScore = 0;
+    bool bTied = false;
+    for (const Xref::Reference& reference : index.References()) {
+        // Operand position inside the referencing instruction, rel32 at the end of the instruction like GetAbsolute() expects
+        int64_t iMatch = -1;
+        for (int64_t iOperand = reference.iSource + 1; iOperand < reference.iSource + 12 && iOperand + 4 <= iImageSize; iOperand++) {
+            if (iOperand + 4 + *reinterpret_cast<int32_t*>(base + iOperand) == reference.iTarget) {
+                iMatch = iOperand - signature.iAbsoluteOffset;
+                break;
+            }
+        }
+        if (iMatch < 0 || iMatch + (int64_t)pattern.size() > iImageSize)
+            continue;
+
+        size_t iScore = 0;
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (pattern[i] != -1 && base[iMatch + i] == pattern[i])
+                iScore++;
+        }
+        if (iScore > iBestScore) {
+            best = base + iMatch;
+            iBestScore = iScore;
+            bTied = false;
+        }
+        else if (iScore == iBestScore && best != base + iMatch) {
+            bTied = true;
+        }
+    }
+
+    if (!best || bTied || iBestScore * 4 < iConcrete * 3) {
+        spdlog::error("Cross References: No candidate for {} ({} of {} bytes at best{}).", signature.sName, iBestScore, iConcrete, bTied ? ", ambiguous" : "");
+        return;
+    }
+
+    spdlog::warn("Cross References: {} may have moved to {:s}+{:x} ({} of {} bytes match), not patched. Check it and regenerate the signature with siggen.",
+        signature.sName, sExeName.c_str(), best - base, iBestScore, iConcrete);
+}
+
+// Cached results are only trusted if the signature still matches at the cached RVA
+uint8_t* FindSignature(const Signatures::Signature& signature)
+{
+    if (bScanCache) {
+        if (auto cached = scanCache.results.find(signature.sName); cached != scanCache.results.end()) {
+            uint32_t iImageSize = Memory::ModuleSize(baseModule);
+            uint8_t* address = reinterpret_cast<uint8_t*>(baseModule) + cached->second;
+            if (cached->second < iImageSize && Signatures::Matches(address, iImageSize - cached->second, Signatures::ParsePattern(signature.sPattern))) {
+                SymbolMap::AddSite(address, signature.sFeature, signature.sName);
+                return address;
+            }
+
+            spdlog::warn("Scan Cache: {} no longer matches at {:s}+{:x}, rescanning.", signature.sName, sExeName.c_str(), cached->second);
+            scanCache.results.erase(cached);
+            bScanCacheDirty = true;
+        }
+    }
+
+    uint8_t* result = Memory::PatternScan(baseModule, signature.sPattern);
+    if (!result && signature.bAbsolute)
+        ReportSignatureCandidate(signature);
+    SymbolMap::AddSite(result, signature.sFeature, signature.sName);
+    if (result && bScanCache) {
+        scanCache.results[signature.sName] = static_cast<uint32_t>(result - reinterpret_cast<uint8_t*>(baseModule));
+        bScanCacheDirty = true;
+    }
+    return result;
+}
+
 void Resolution()
 {
     if (bCustomRes) {
         // Add custom resolution
-        uint8_t* ResolutionListScanResult = Memory::PatternScan(baseModule, "4C ?? ?? ?? ?? ?? ?? 41 ?? ?? 41 ?? ?? 45 ?? ?? ?? ?? C7 ?? ?? ?? ?? ?? ??");
-        uint8_t* ResolutionIndexScanResult = Memory::PatternScan(baseModule, "83 ?? 0F 0F ?? ?? 89 ?? ?? ?? ?? ?? C3");
-        if (ResolutionListScanResult && ResolutionIndexScanResult) {
+        auto ResolutionEntry = PrePatch::ResolutionEntry(iCustomResX, iCustomResY);
+        bool bPrePatchedResolution = IsPrePatched("ResolutionList", ResolutionEntry.data(), ResolutionEntry.size())
+            && IsPrePatched("ResolutionIndex", &PrePatch::iForcedResolutionIndex, sizeof(PrePatch::iForcedResolutionIndex));
+        uint8_t* ResolutionListScanResult = bPrePatchedResolution ? nullptr : FindSignature(Signatures::ResolutionList);
+        uint8_t* ResolutionIndexScanResult = FindSignature(Signatures::ResolutionIndex);
+        bool bForceResolutionIndex = false;
+        if (bPrePatchedResolution && ResolutionIndexScanResult) {
+            spdlog::info("Resolution: Replaced {}x{} with {}x{} (pre-patched)", 800, 450, (short)iCustomResX, (short)iCustomResY);
+            bForceResolutionIndex = true;
+        }
+        else if (ResolutionListScanResult && ResolutionIndexScanResult) {
             spdlog::info("Resolution: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResolutionListScanResult - (uintptr_t)baseModule);
-            uintptr_t ResListAddr = Memory::GetAbsolute((uintptr_t)ResolutionListScanResult + 0x3);
+            uintptr_t ResListAddr = Memory::GetAbsolute((uintptr_t)ResolutionListScanResult + Signatures::ResolutionList.iAbsoluteOffset);
             spdlog::info("Resolution: Resolution list address is {:s}+{:x}", sExeName.c_str(), ResListAddr - (uintptr_t)baseModule);
-         
+
+            spdlog::info("Resolution: Index address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResolutionIndexScanResult - (uintptr_t)baseModule);
+            uintptr_t ResIndexAddr = Memory::GetAbsolute((uintptr_t)ResolutionIndexScanResult + Signatures::ResolutionIndex.iAbsoluteOffset);
+            spdlog::info("Resolution: Resolution index address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResIndexAddr - (uintptr_t)baseModule);
+
             // Write new resolution
             Memory::Write(ResListAddr + 0x6, (short)iCustomResX);
             Memory::Write(ResListAddr + 0x8, (short)iCustomResY);
             Memory::Write(ResListAddr + 0xA, (short)iCustomResY);
             spdlog::info("Resolution: Replaced {}x{} with {}x{}", 800, 450, (short)iCustomResX, (short)iCustomResY);
 
-            spdlog::info("Resolution: Index address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResolutionIndexScanResult - (uintptr_t)baseModule);
-            uintptr_t ResIndexAddr = Memory::GetAbsolute((uintptr_t)ResolutionIndexScanResult - 0x4);
-            spdlog::info("Resolution: Resolution index address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResIndexAddr - (uintptr_t)baseModule);
-
             // Force 800x450 on startup
             *reinterpret_cast<int*>(ResIndexAddr) = 1;
+            bForceResolutionIndex = true;
+        }
+        else if (!ResolutionListScanResult || !ResolutionIndexScanResult) {
+            spdlog::error("Resolution Fix: Pattern scan failed.");
+        }
 
+        if (bForceResolutionIndex) {
             static SafetyHookMid ForceResMidHook{};
-            ForceResMidHook = safetyhook::create_mid(ResolutionIndexScanResult + 0x6,
+            ForceResMidHook = HookArena::CreateMid(ResolutionIndexScanResult + 0x6,
                 [](SafetyHookContext& ctx) {
                     // Force 800x450 on any resolution change
                     ctx.rcx = 1;
                 });
         }
-        else if (!ResolutionListScanResult || !ResolutionIndexScanResult) {
-            spdlog::error("Resolution Fix: Pattern scan failed.");
-        }
 
         // Spoof GetSystemMetrics results
-        uint8_t* SystemMetrics1ScanResult = Memory::PatternScan(baseModule, "B9 01 00 00 00 41 ?? ?? 99 2B ?? D1 ?? 8B ??");
-        uint8_t* SystemMetrics2ScanResult = Memory::PatternScan(baseModule, "0F ?? ?? 3B ?? 7C ?? B9 01 00 00 00 FF ?? ?? ?? ?? ?? 0F ?? ?? ?? 3B ?? 7D ?? 33 ??");
-        uint8_t* ResCheckScanResult = Memory::PatternScan(baseModule, "74 ?? 33 ?? FF ?? ?? ?? ?? ?? 0F ?? ?? ?? 3B ?? 7C ??");
+        uint8_t* SystemMetrics1ScanResult = FindSignature(Signatures::SystemMetrics1);
+        uint8_t* SystemMetrics2ScanResult = FindSignature(Signatures::SystemMetrics2);
+        bool bPrePatchedResCheck = IsPrePatched("ResCheck", PrePatch::JumpShort, sizeof(PrePatch::JumpShort));
+        uint8_t* ResCheckScanResult = bPrePatchedResCheck ? nullptr : FindSignature(Signatures::ResCheck);
         if (SystemMetrics1ScanResult && SystemMetrics2ScanResult) {
             spdlog::info("SystemMetrics: 1: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)SystemMetrics1ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid WindowWidthMidHook{};
-            WindowWidthMidHook = safetyhook::create_mid(SystemMetrics1ScanResult,
+            WindowWidthMidHook = HookArena::CreateMid(SystemMetrics1ScanResult,
                 [](SafetyHookContext& ctx) {
                     ctx.rax = INT_MAX;
                 });
 
             static SafetyHookMid WindowHeightMidHook{};
-            WindowHeightMidHook = safetyhook::create_mid(SystemMetrics1ScanResult + 0x15,
+            WindowHeightMidHook = HookArena::CreateMid(SystemMetrics1ScanResult + 0x15,
                 [](SafetyHookContext& ctx) {
                     ctx.rax = INT_MAX;
                 });
 
             spdlog::info("SystemMetrics: 2: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)SystemMetrics2ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid sysWidthMidHook{};
-            sysWidthMidHook = safetyhook::create_mid(SystemMetrics2ScanResult,
+            sysWidthMidHook = HookArena::CreateMid(SystemMetrics2ScanResult,
                 [](SafetyHookContext& ctx) {
                     ctx.rax = INT_MAX;
                 });
 
             static SafetyHookMid sysHeightMidHook{};
-            sysHeightMidHook = safetyhook::create_mid(SystemMetrics2ScanResult + 0x12,
+            sysHeightMidHook = HookArena::CreateMid(SystemMetrics2ScanResult + 0x12,
                 [](SafetyHookContext& ctx) {
                     ctx.rax = INT_MAX;
                 });
 
-            spdlog::info("SystemMetrics: ResCheck: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResCheckScanResult - (uintptr_t)baseModule);
-            Memory::PatchBytes((uintptr_t)ResCheckScanResult, "\xEB", 1);
+            if (bPrePatchedResCheck) {
+                spdlog::info("SystemMetrics: ResCheck: Instruction is pre-patched.");
+            }
+            else if (ResCheckScanResult) {
+                spdlog::info("SystemMetrics: ResCheck: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ResCheckScanResult - (uintptr_t)baseModule);
+                Memory::PatchBytes((uintptr_t)ResCheckScanResult, "\xEB", 1);
 
-            spdlog::info("SystemMetrics: ResCheck: Patched instruction.");
+                spdlog::info("SystemMetrics: ResCheck: Patched instruction.");
+            }
         }
         else if (!SystemMetrics1ScanResult || !SystemMetrics2ScanResult) {
             spdlog::error("SystemMetrics: Pattern scan(s) failed.");
         }
 
         // Window mode
-        uint8_t* WindowModeScanResult = Memory::PatternScan(baseModule, "8B ?? ?? ?? ?? ?? 48 ?? ?? 83 ?? 02 0F 83 ?? ?? ?? ?? 83 ?? 01");
+        if (bBorderlessMode)
+            bWindowedMode = true; // Force windowed mode if using borderless
+
+        const int iWindowMode = (int)bWindowedMode;
+        if (IsPrePatched("WindowMode", &iWindowMode, sizeof(iWindowMode))) {
+            spdlog::info("Window Mode: iWindowMode is pre-patched.");
+            return;
+        }
+
+        uint8_t* WindowModeScanResult = FindSignature(Signatures::WindowMode);
         if (WindowModeScanResult) {
             spdlog::info("Window Mode: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)WindowModeScanResult - (uintptr_t)baseModule);
-            uintptr_t iWindowModeAddr = Memory::GetAbsolute((uintptr_t)WindowModeScanResult + 0x2);
+            uintptr_t iWindowModeAddr = Memory::GetAbsolute((uintptr_t)WindowModeScanResult + Signatures::WindowMode.iAbsoluteOffset);
             spdlog::info("Window Mode: iWindowMode address is {:s}+{:x}", sExeName.c_str(), iWindowModeAddr - (uintptr_t)baseModule);
 
-            if (bBorderlessMode)
-                bWindowedMode = true; // Force windowed mode if using borderless
-
             if (iWindowModeAddr)
-                Memory::Write(iWindowModeAddr, (int)bWindowedMode);
+                Memory::Write(iWindowModeAddr, iWindowMode);
         }
         else if (!WindowModeScanResult) {
             spdlog::error("Window Mode: Pattern scan failed.");
@@ -418,30 +1460,24 @@ void AspectFOV()
 {
     if (bFixAspect) {
         // Aspect ratio
-        uint8_t* AspectRatioScanResult = Memory::PatternScan(baseModule, "8B ?? ?? ?? ?? ?? C6 ?? ?? ?? ?? ?? 01 89 ?? ?? ?? ?? ?? 40 ?? ?? ?? ?? ?? ?? 75 ??");
+        uint8_t* AspectRatioScanResult = FindSignature(Signatures::AspectRatio);
         if (AspectRatioScanResult) {
             spdlog::info("Aspect Ratio: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)AspectRatioScanResult - (uintptr_t)baseModule);
             static SafetyHookMid AspectRatioMidHook{};
-            AspectRatioMidHook = safetyhook::create_mid(AspectRatioScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rbx + 0x1B0) {
-                        *reinterpret_cast<float*>(ctx.rbx + 0x1B0) = fAspectRatio;
-                    }
-                });
+            AspectRatioMidHook = HookArena::CreateMid(AspectRatioScanResult, Benchmark::Gate(Benchmark::Group::FOV, Capture::Wrap(Capture::Site::AspectRatio)));
         }
         else if (!AspectRatioScanResult) {
             spdlog::error("Aspect Ratio: Pattern scan failed.");
         }
 
         // Menu Aspect Ratio
-        uint8_t* MenuAspectRatioScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??");
+        uint8_t* MenuAspectRatioScanResult = FindSignature(Signatures::MenuAspectRatio);
         if (MenuAspectRatioScanResult) {
             spdlog::info("Menu Aspect Ratio: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MenuAspectRatioScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid MenuAspectRatioMidHook{};
-            MenuAspectRatioMidHook = safetyhook::create_mid(MenuAspectRatioScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm0.f32[0] = fAspectRatio;
-                });
+            static LightHook MenuAspectRatioHook{};
+            MenuAspectRatioHook = LightHook::CreateXmm(MenuAspectRatioScanResult, 0, fAspectRatio);
+            Layout::Bind([]() { MenuAspectRatioHook.Set(fAspectRatio); });
+            Benchmark::Track(Benchmark::Group::FOV, MenuAspectRatioHook);
         }
         else if (!MenuAspectRatioScanResult) {
             spdlog::error("Menu Aspect Ratio: Pattern scan failed.");
@@ -449,15 +1485,11 @@ void AspectFOV()
     }
 
     if (bFixFOV) {
-        uint8_t* GlobalFOVScanResult = Memory::PatternScan(baseModule, "0F ?? ?? ?? ?? D1 ?? 44 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? A8 01");
+        uint8_t* GlobalFOVScanResult = FindSignature(Signatures::GlobalFOV);
         if (GlobalFOVScanResult) {
             spdlog::info("FOV: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GlobalFOVScanResult - (uintptr_t)baseModule);
             static SafetyHookMid GlobalFOVMidHook{};
-            GlobalFOVMidHook = safetyhook::create_mid(GlobalFOVScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm0.f32[0] = 2.00f * atanf(tanf(ctx.xmm0.f32[0] / 2.00f) * (fNativeAspect / fAspectRatio));
-                });
+            GlobalFOVMidHook = HookArena::CreateMid(GlobalFOVScanResult, Benchmark::Gate(Benchmark::Group::FOV, Capture::Wrap(Capture::Site::GlobalFOV)));
         }
         else if (!GlobalFOVScanResult) {
             spdlog::error("FOV: Pattern scan failed.");
@@ -466,22 +1498,16 @@ void AspectFOV()
 
     if (fGameplayFOVMulti != 1.00f) {
         // Gameplay FOV
-        uint8_t* GameplayFOVScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ??");
-        uint8_t* GameplayLockOnFOVScanResult = Memory::PatternScan(baseModule, "0F ?? ?? E8 ?? ?? ?? ?? F3 44 ?? ?? ?? ?? ?? 41 0F ?? ?? 0F ?? ?? 0F ?? ??");
+        uint8_t* GameplayFOVScanResult = FindSignature(Signatures::GameplayFOV);
+        uint8_t* GameplayLockOnFOVScanResult = FindSignature(Signatures::GameplayLockOnFOV);
         if (GameplayFOVScanResult && GameplayLockOnFOVScanResult) {
             spdlog::info("Gameplay FOV: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GameplayFOVScanResult - (uintptr_t)baseModule);
             static SafetyHookMid GameplayFOVMidHook{};
-            GameplayFOVMidHook = safetyhook::create_mid(GameplayFOVScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm0.f32[0] *= fGameplayFOVMulti;
-                });
+            GameplayFOVMidHook = HookArena::CreateMid(GameplayFOVScanResult, Benchmark::Gate(Benchmark::Group::FOV, Capture::Wrap(Capture::Site::GameplayFOV)));
 
             spdlog::info("Gameplay FOV: Lock-On: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GameplayLockOnFOVScanResult - (uintptr_t)baseModule);
             static SafetyHookMid GameplayLockOnFOVMidHook{};
-            GameplayLockOnFOVMidHook = safetyhook::create_mid(GameplayLockOnFOVScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm7.f32[0] *= fGameplayFOVMulti;
-                });
+            GameplayLockOnFOVMidHook = HookArena::CreateMid(GameplayLockOnFOVScanResult, Benchmark::Gate(Benchmark::Group::FOV, Capture::Wrap(Capture::Site::GameplayLockOnFOV)));
         }
         else if (!GameplayFOVScanResult || !!GameplayLockOnFOVScanResult) {
             spdlog::error("Gameplay FOV: Pattern scan(s) failed.");
@@ -496,354 +1522,228 @@ void HUD()
 
     if (bFixHUD) {
         // HUD Size
-        uint8_t* HUDSizeScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 8B ?? ?? ?? 89 ?? ??");
+        uint8_t* HUDSizeScanResult = FindSignature(Signatures::HUDSize);
         if (HUDSizeScanResult) {
             spdlog::info("HUD: Size: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDSizeScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid HUDWidthMidHook{};
-            HUDWidthMidHook = safetyhook::create_mid(HUDSizeScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm0.f32[0] = fHUDWidth;
-                });
+            static LightHook HUDWidthHook{};
+            HUDWidthHook = LightHook::CreateXmm(HUDSizeScanResult, 0, fHUDWidth);
+            Layout::Bind([]() {
+                HUDWidthHook.Set(fHUDWidth);
+                Benchmark::Enable(HUDWidthHook, fAspectRatio > fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, HUDWidthHook);
 
-            static SafetyHookMid HUDHeightMidHook{};
-            HUDHeightMidHook = safetyhook::create_mid(HUDSizeScanResult - 0x23,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm1.f32[0] = fHUDHeight;
-                });
+            static LightHook HUDHeightHook{};
+            HUDHeightHook = LightHook::CreateXmm(HUDSizeScanResult - 0x23, 1, fHUDHeight);
+            Layout::Bind([]() {
+                HUDHeightHook.Set(fHUDHeight);
+                Benchmark::Enable(HUDHeightHook, fAspectRatio < fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, HUDHeightHook);
         }
         else if (!HUDSizeScanResult) {
             spdlog::error("HUD: Size: Pattern scan failed.");
         }
 
         // HUD Offset
-        uint8_t* HUDOffsetCodepathScanResult = Memory::PatternScan(baseModule, "7A ?? 75 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 7A ?? 74 ?? 48 ?? ?? ?? ?? ?? ?? 00 74 ??");
-        uint8_t* HUDOffsetScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 0F ?? ?? ?? 42 ?? ?? ?? ??");
-        if (HUDOffsetCodepathScanResult && HUDOffsetScanResult) {
-            spdlog::info("HUD: Offset: Codepath address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDOffsetCodepathScanResult - (uintptr_t)baseModule);
-            Memory::PatchBytes((uintptr_t)HUDOffsetCodepathScanResult, "\xEB", 1);
-            spdlog::info("HUD: Offset: Patched instruction.");
+        bool bPrePatchedHUDOffsetCodepath = IsPrePatched("HUDOffsetCodepath", PrePatch::JumpShort, sizeof(PrePatch::JumpShort));
+        uint8_t* HUDOffsetCodepathScanResult = bPrePatchedHUDOffsetCodepath ? nullptr : FindSignature(Signatures::HUDOffsetCodepath);
+        uint8_t* HUDOffsetScanResult = FindSignature(Signatures::HUDOffset);
+        if ((bPrePatchedHUDOffsetCodepath || HUDOffsetCodepathScanResult) && HUDOffsetScanResult) {
+            if (bPrePatchedHUDOffsetCodepath) {
+                spdlog::info("HUD: Offset: Codepath instruction is pre-patched.");
+            }
+            else {
+                spdlog::info("HUD: Offset: Codepath address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDOffsetCodepathScanResult - (uintptr_t)baseModule);
+                Memory::PatchBytes((uintptr_t)HUDOffsetCodepathScanResult, "\xEB", 1);
+                spdlog::info("HUD: Offset: Patched instruction.");
+            }
 
             spdlog::info("HUD: Offset: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDOffsetScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid HUDWidthOffsetMidHook{};
-            HUDWidthOffsetMidHook = safetyhook::create_mid(HUDOffsetScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm0.f32[0] = -(fNativeAspect / fAspectRatio);
-                });
+            static LightHook HUDWidthOffsetHook{};
+            HUDWidthOffsetHook = LightHook::CreateXmm(HUDOffsetScanResult, 0, -(fNativeAspect / fAspectRatio));
+            Layout::Bind([]() {
+                HUDWidthOffsetHook.Set(-(fNativeAspect / fAspectRatio));
+                Benchmark::Enable(HUDWidthOffsetHook, fAspectRatio > fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, HUDWidthOffsetHook);
 
-            static SafetyHookMid HUDHeightOffsetMidHook{};
-            HUDHeightOffsetMidHook = safetyhook::create_mid(HUDOffsetScanResult + 0xD,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm1.f32[0] = fAspectMultiplier;
-                });
+            static LightHook HUDHeightOffsetHook{};
+            HUDHeightOffsetHook = LightHook::CreateXmm(HUDOffsetScanResult + 0xD, 1, fAspectMultiplier);
+            Layout::Bind([]() {
+                HUDHeightOffsetHook.Set(fAspectMultiplier);
+                Benchmark::Enable(HUDHeightOffsetHook, fAspectRatio < fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, HUDHeightOffsetHook);
         }
         else if (!HUDOffsetCodepathScanResult || !HUDOffsetScanResult) {
             spdlog::error("HUD: Offset: Pattern scan(s) failed.");
         }
 
         // Enemy Nameplates
-        uint8_t* EnemyNamesScanResult = Memory::PatternScan(baseModule, "B8 ?? ?? ?? ?? 6B ?? ?? F7 ?? 03 ?? C1 ?? ?? 8B ?? C1 ?? ?? 03 ?? 49 ?? ?? ??");
+        uint8_t* EnemyNamesScanResult = FindSignature(Signatures::EnemyNames);
         if (EnemyNamesScanResult) {
             spdlog::info("HUD: Enemy Names: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)EnemyNamesScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid EnemyNamesWidthMidHook{};
-            EnemyNamesWidthMidHook = safetyhook::create_mid(EnemyNamesScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.rcx = static_cast<int>(fHUDWidth);
-                });
+            // These fire once per visible enemy, so only load ecx instead of going through a full context stub.
+            static LightHook EnemyNamesWidthHook{};
+            EnemyNamesWidthHook = LightHook::CreateGpr32(EnemyNamesScanResult, 1, static_cast<uint32_t>(fHUDWidth));
+            Layout::Bind([]() {
+                EnemyNamesWidthHook.Set(static_cast<uint32_t>(fHUDWidth));
+                Benchmark::Enable(EnemyNamesWidthHook, fAspectRatio > fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, EnemyNamesWidthHook);
 
-            static SafetyHookMid EnemyNamesHeightMidHook{};
-            EnemyNamesHeightMidHook = safetyhook::create_mid(EnemyNamesScanResult + 0x1D,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.rcx = static_cast<int>(fHUDHeight);
-                });
+            static LightHook EnemyNamesHeightHook{};
+            EnemyNamesHeightHook = LightHook::CreateGpr32(EnemyNamesScanResult + 0x1D, 1, static_cast<uint32_t>(fHUDHeight));
+            Layout::Bind([]() {
+                EnemyNamesHeightHook.Set(static_cast<uint32_t>(fHUDHeight));
+                Benchmark::Enable(EnemyNamesHeightHook, fAspectRatio < fNativeAspect);
+            });
+            Benchmark::Track(Benchmark::Group::HUD, EnemyNamesHeightHook);
         }
         else if (!EnemyNamesScanResult) {
             spdlog::error("HUD: Enemy Names: Pattern scan failed.");
         }
 
         // Movies
-        uint8_t* MoviesScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? 00 00 00 00 0F ?? ??");
+        uint8_t* MoviesScanResult = FindSignature(Signatures::Movies);
         if (MoviesScanResult) {
             spdlog::info("HUD: Movies: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MoviesScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid MovieWidthMidHook{};
-            MovieWidthMidHook = safetyhook::create_mid(MoviesScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio > fNativeAspect)
-                        ctx.xmm0.f32[0] = fHUDWidth;
+            if (bTimeline) {
+                // Needs a callback for timeline events
+                static SafetyHookMid MovieWidthMidHook{};
+                MovieWidthMidHook = HookArena::CreateMid(MoviesScanResult,
+                    Benchmark::Gate(Benchmark::Group::HUD, [](SafetyHookContext& ctx) {
+                        Timeline::Instant("HUD: Movie");
+                        if (fAspectRatio > fNativeAspect)
+                            ctx.xmm0.f32[0] = fHUDWidth;
+                    }));
+
+                static SafetyHookMid MovieHeightMidHook{};
+                MovieHeightMidHook = HookArena::CreateMid(MoviesScanResult + 0x18,
+                    Benchmark::Gate(Benchmark::Group::HUD, [](SafetyHookContext& ctx) {
+                        if (fAspectRatio < fNativeAspect)
+                            ctx.xmm1.f32[0] = fHUDHeight;
+                    }));
+            }
+            else {
+                static LightHook MovieWidthHook{};
+                MovieWidthHook = LightHook::CreateXmm(MoviesScanResult, 0, fHUDWidth);
+                Layout::Bind([]() {
+                    MovieWidthHook.Set(fHUDWidth);
+                    Benchmark::Enable(MovieWidthHook, fAspectRatio > fNativeAspect);
                 });
+                Benchmark::Track(Benchmark::Group::HUD, MovieWidthHook);
 
-            static SafetyHookMid MovieHeightMidHook{};
-            MovieHeightMidHook = safetyhook::create_mid(MoviesScanResult + 0x18,
-                [](SafetyHookContext& ctx) {
-                    if (fAspectRatio < fNativeAspect)
-                        ctx.xmm1.f32[0] = fHUDHeight;
+                static LightHook MovieHeightHook{};
+                MovieHeightHook = LightHook::CreateXmm(MoviesScanResult + 0x18, 1, fHUDHeight);
+                Layout::Bind([]() {
+                    MovieHeightHook.Set(fHUDHeight);
+                    Benchmark::Enable(MovieHeightHook, fAspectRatio < fNativeAspect);
                 });
+                Benchmark::Track(Benchmark::Group::HUD, MovieHeightHook);
+            }
         }
         else if (!MoviesScanResult) {
             spdlog::error("HUD: Movies: Pattern scan failed.");
         }
 
         // Fades
-        uint8_t* FadesScanResult = Memory::PatternScan(baseModule, "66 0F ?? ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ?? 0F ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ??");
+        uint8_t* FadesScanResult = FindSignature(Signatures::Fades);
         if (FadesScanResult) {
             spdlog::info("HUD: Fades: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FadesScanResult - (uintptr_t)baseModule);
             static SafetyHookMid FadeWidthMidHook{};
-            FadeWidthMidHook = safetyhook::create_mid(FadesScanResult + 0x5,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.xmm2.f32[0] == 1920.00f) {
-                        if (fAspectRatio > fNativeAspect) {
-                            ctx.xmm0.f32[0] = -(((1080.00f * fAspectRatio) - 1920.00f) / 2.00f);
-                            ctx.xmm2.f32[0] = 1080.00f * fAspectRatio;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            ctx.xmm1.f32[0] = -(((1920.00f / fAspectRatio) - 1080.00f) / 2.00f);
-                        }
-                    }
-                });
+            FadeWidthMidHook = HookArena::CreateMid(FadesScanResult + 0x5, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::FadeWidth)));
 
             static SafetyHookMid FadeHeightMidHook{};
-            FadeHeightMidHook = safetyhook::create_mid(FadesScanResult + 0x12,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.xmm2.f32[0] == 1920.00f) {
-                        if (fAspectRatio < fNativeAspect)
-                            ctx.xmm3.f32[0] = 1920.00f / fAspectRatio;                    
-                    }
-                });
+            FadeHeightMidHook = HookArena::CreateMid(FadesScanResult + 0x12, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::FadeHeight)));
         }
         else if (!FadesScanResult) {
             spdlog::error("HUD: Fades: Pattern scan failed.");
         }
 
         // Pause background
-        uint8_t* PauseCaptureScanResult = Memory::PatternScan(baseModule, "C7 ?? ?? ?? 00 00 87 44 F3 0F ?? ?? ?? ?? 44 ?? ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ??");
-        uint8_t* PauseBGScanResult = Memory::PatternScan(baseModule, "D2 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ??");
+        uint8_t* PauseCaptureScanResult = FindSignature(Signatures::PauseCapture);
+        uint8_t* PauseBGScanResult = FindSignature(Signatures::PauseBG);
         if (PauseCaptureScanResult && PauseBGScanResult) {
             spdlog::info("HUD: Pause Screen: Capture: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)PauseCaptureScanResult - (uintptr_t)baseModule);
             static SafetyHookMid PauseCaptureMidHook{};
-            PauseCaptureMidHook = safetyhook::create_mid(PauseCaptureScanResult + 0x8,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x50) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x50) = (1080.00f * fAspectRatio) - fWidthOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x48) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x54) = (1920.00f / fAspectRatio) - fHeightOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x4C) = -fHeightOffset;
-                        }
-                    }
-                });
+            PauseCaptureMidHook = HookArena::CreateMid(PauseCaptureScanResult + 0x8,
+                Benchmark::Gate(Benchmark::Group::HUD, [](SafetyHookContext& ctx) {
+                    Timeline::Instant("HUD: Pause Capture");
+                    Capture::Run<Capture::Site::PauseCapture>(ctx);
+                }));
 
             spdlog::info("HUD: Pause Screen: Background: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)PauseCaptureScanResult - (uintptr_t)baseModule);
             static SafetyHookMid PauseBGMidHook{};
-            PauseBGMidHook = safetyhook::create_mid(PauseBGScanResult + 0x21,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rcx + 0x20 && ctx.xmm1.f32[0] == 1920.00f)
-                    {
-                        if (fAspectRatio > fNativeAspect) {
-                            ctx.xmm1.f32[0] = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rcx + 0x20) = -((ctx.xmm1.f32[0] - 1920.00f) / 2.00f);
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            ctx.xmm0.f32[0] = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rcx + 0x24) = -((ctx.xmm0.f32[0] - 1080.00f) / 2.00f);
-                        }
-                    }
-                });
+            PauseBGMidHook = HookArena::CreateMid(PauseBGScanResult + 0x21,
+                Benchmark::Gate(Benchmark::Group::HUD, [](SafetyHookContext& ctx) {
+                    Timeline::Instant("HUD: Pause Background");
+                    Capture::Run<Capture::Site::PauseBackground>(ctx);
+                }));
         }
         else if (!PauseCaptureScanResult || !PauseBGScanResult) {
             spdlog::error("HUD: Pause Screen: Pattern scan(s) failed.");
         }
 
         // Mission select
-        uint8_t* MissionSelectCaptureScanResult = Memory::PatternScan(baseModule, "E8 ?? ?? ?? ?? 48 8B ?? ?? ?? ?? ?? ?? 45 ?? ?? BA 01 00 00 00 E8 ?? ?? ?? ??");
-        uint8_t* MissionSelectBGScanResult = Memory::PatternScan(baseModule, "48 ?? ?? ?? 49 ?? ?? ?? 4C ?? ?? ?? 4C ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? 48 ?? ?? ?? 5F C3");
+        uint8_t* MissionSelectCaptureScanResult = FindSignature(Signatures::MissionSelectCapture);
+        uint8_t* MissionSelectBGScanResult = FindSignature(Signatures::MissionSelectBG);
         if (MissionSelectCaptureScanResult && MissionSelectBGScanResult) {
             spdlog::info("HUD: Mission Select Screen: Capture: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MissionSelectCaptureScanResult - (uintptr_t)baseModule);
             static SafetyHookMid MissionSelectCaptureMidHook{};
-            MissionSelectCaptureMidHook = safetyhook::create_mid(MissionSelectCaptureScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x40 && ctx.xmm0.f32[0] == 1920.00f) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x48) = (1080.00f * fAspectRatio) - fWidthOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x40) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x4C) = (1920.00f / fAspectRatio) - fHeightOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x44) = -fHeightOffset;
-                        }
-                    }
-                });
+            MissionSelectCaptureMidHook = HookArena::CreateMid(MissionSelectCaptureScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::MissionSelectCapture)));
 
             spdlog::info("HUD: Mission Select Screen: Background: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MissionSelectBGScanResult - (uintptr_t)baseModule);
             static SafetyHookMid MissionSelectBGMidHook{};
-            MissionSelectBGMidHook = safetyhook::create_mid(MissionSelectBGScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.r8 + 0x20 && ctx.xmm1.f32[0] == 1920.00f) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x28) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x20) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x2C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x24) = -fHeightOffset;
-                        }
-                    }
-                });
+            MissionSelectBGMidHook = HookArena::CreateMid(MissionSelectBGScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::MissionSelectBackground)));
         }
         else if (!MissionSelectCaptureScanResult || !MissionSelectBGScanResult) {
             spdlog::error("HUD: MissionSelect Screen: Pattern scan(s) failed.");
         }
 
         // Menu Backgrounds
-        uint8_t* MenuBackgroundsScanResult = Memory::PatternScan(baseModule, "7E ?? 49 ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 4C ?? ?? ?? ?? 4C ?? ?? ?? ??");
+        uint8_t* MenuBackgroundsScanResult = FindSignature(Signatures::MenuBackgrounds);
         if (MenuBackgroundsScanResult) {
             spdlog::info("HUD: Backgrounds: Menu: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)MenuBackgroundsScanResult - (uintptr_t)baseModule);
             static SafetyHookMid MenuBackgroundsMidHook{};
-            MenuBackgroundsMidHook = safetyhook::create_mid(MenuBackgroundsScanResult + 0x2,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x50 && ctx.xmm0.f32[0] == (float)iCustomResX && ctx.xmm1.f32[0] == (float)iCustomResY) {
-                        if (fAspectRatio > fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x58) = fHUDWidth + fHUDWidthOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x50) = fHUDWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rsp + 0x5C) = fHUDHeight + fHUDHeightOffset;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x54) = fHUDHeightOffset;
-                        }
-                    }
-                });
+            MenuBackgroundsMidHook = HookArena::CreateMid(MenuBackgroundsScanResult + 0x2, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::MenuBackgrounds)));
         }
         else if (!MenuBackgroundsScanResult) {
             spdlog::error("HUD: Menu Backgrounds: Pattern scan failed.");
         }
 
         // HUD Backgrounds
-        uint8_t* HUDBackgrounds1ScanResult = Memory::PatternScan(baseModule, "8B ?? 89 ?? ?? 48 8B ?? ?? 48 89 ?? ?? 48 89 ?? ?? 48 89 ?? ??");
-        uint8_t* HUDBackgrounds2ScanResult = Memory::PatternScan(baseModule, "45 ?? ?? 0F 84 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 33 ?? 83 ?? ?? ?? ?? ?? 03");
-        uint8_t* HUDBackgrounds3ScanResult = Memory::PatternScan(baseModule, "48 8B ?? ?? 48 89 ?? ?? 48 89 ?? ?? 48 89 ?? ?? 83 ?? ?? ?? ?? ?? 00 74 ??");
-        uint8_t* HUDBackgrounds4ScanResult = Memory::PatternScan(baseModule, "48 ?? ?? ?? 89 ?? ?? 44 0F ?? ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ??");
-        uint8_t* HUDBackgrounds5ScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? ?? ?? 85 ?? 74 ?? FF ?? 74 ?? FF ?? 75 ??");
-        uint8_t* HUDBackgrounds6ScanResult = Memory::PatternScan(baseModule, "F3 41 ?? ?? ?? ?? F3 45 ?? ?? ?? ?? 85 ?? 74 ?? 83 ?? 0F"); 
+        uint8_t* HUDBackgrounds1ScanResult = FindSignature(Signatures::HUDBackgrounds1);
+        uint8_t* HUDBackgrounds2ScanResult = FindSignature(Signatures::HUDBackgrounds2);
+        uint8_t* HUDBackgrounds3ScanResult = FindSignature(Signatures::HUDBackgrounds3);
+        uint8_t* HUDBackgrounds4ScanResult = FindSignature(Signatures::HUDBackgrounds4);
+        uint8_t* HUDBackgrounds5ScanResult = FindSignature(Signatures::HUDBackgrounds5);
+        uint8_t* HUDBackgrounds6ScanResult = FindSignature(Signatures::HUDBackgrounds6);
         if (HUDBackgrounds1ScanResult && HUDBackgrounds2ScanResult && HUDBackgrounds3ScanResult && HUDBackgrounds4ScanResult && HUDBackgrounds5ScanResult && HUDBackgrounds6ScanResult) {
             spdlog::info("HUD: Backgrounds: Other 1: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds1ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds1MidHook{};
-            HUDBackgrounds1MidHook = safetyhook::create_mid(HUDBackgrounds1ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rdx + 0x20) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x28) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x20) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x2C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x24) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds1MidHook = HookArena::CreateMid(HUDBackgrounds1ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds1)));
 
             spdlog::info("HUD: Backgrounds: Other 2: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds2ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds2MidHook{};
-            HUDBackgrounds2MidHook = safetyhook::create_mid(HUDBackgrounds2ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x40) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x48) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x40) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x4C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x44) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds2MidHook = HookArena::CreateMid(HUDBackgrounds2ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds2)));
 
             spdlog::info("HUD: Backgrounds: Other 3: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds3ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds3MidHook{};
-            HUDBackgrounds3MidHook = safetyhook::create_mid(HUDBackgrounds3ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rdx + 0x20) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x28) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x20) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x2C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x24) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds3MidHook = HookArena::CreateMid(HUDBackgrounds3ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds3)));
 
             spdlog::info("HUD: Backgrounds: Other 4: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds4ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds4MidHook{};
-            HUDBackgrounds4MidHook = safetyhook::create_mid(HUDBackgrounds4ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rdx + 0x20) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x28) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x20) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x2C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rdx + 0x24) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds4MidHook = HookArena::CreateMid(HUDBackgrounds4ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds4)));
 
             spdlog::info("HUD: Backgrounds: Other 5: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds5ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds5MidHook{};
-            HUDBackgrounds5MidHook = safetyhook::create_mid(HUDBackgrounds5ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.rsp + 0x30) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x38) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x30) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x3C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.rsp + 0x34) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds5MidHook = HookArena::CreateMid(HUDBackgrounds5ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds5)));
 
             spdlog::info("HUD: Backgrounds: Other 6: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)HUDBackgrounds6ScanResult - (uintptr_t)baseModule);
             static SafetyHookMid HUDBackgrounds6MidHook{};
-            HUDBackgrounds6MidHook = safetyhook::create_mid(HUDBackgrounds6ScanResult,
-                [](SafetyHookContext& ctx) {
-                    if (ctx.r8 + 0x30) {
-                        if (fAspectRatio > fNativeAspect) {
-                            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x28) = 1080.00f * fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x20) = -fWidthOffset;
-                        }
-                        else if (fAspectRatio < fNativeAspect) {
-                            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x2C) = 1920.00f / fAspectRatio;
-                            *reinterpret_cast<float*>(ctx.r8 + 0x24) = -fHeightOffset;
-                        }
-                    }
-                });
+            HUDBackgrounds6MidHook = HookArena::CreateMid(HUDBackgrounds6ScanResult, Benchmark::Gate(Benchmark::Group::HUD, Capture::Wrap(Capture::Site::HUDBackgrounds6)));
         }
         else if (!HUDBackgrounds1ScanResult || !HUDBackgrounds2ScanResult || !HUDBackgrounds3ScanResult || !HUDBackgrounds4ScanResult || !HUDBackgrounds5ScanResult || !HUDBackgrounds6ScanResult) {
             spdlog::error("HUD: Backgrounds: Pattern scan(s) failed.");
@@ -851,92 +1751,138 @@ void HUD()
     }   
 }
 
+// Called once per frame from the frame cap hook
+void MetricsFrame()
+{
+    static Metrics::Payload payload{};
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    if (payload.iTimestamp)
+        payload.fFrameTime = static_cast<float>((double)(counter.QuadPart - payload.iTimestamp) * 1000.0 / (double)Metrics::block.load(std::memory_order_relaxed)->header.iFrequency);
+
+    payload.iFrame++;
+    payload.iTimestamp = counter.QuadPart;
+    payload.fGameFrametime = fCurrentFrametime;
+    payload.fFramerateCap = fFramerateCap;
+    payload.fGameSpeedStep = fGameSpeedStep;
+    payload.iResX = iCurrentResX;
+    payload.iResY = iCurrentResY;
+    payload.fAspectRatio = fAspectRatio;
+    payload.iShadowResolution = iShadowResolution;
+    payload.iHookArenaBytes = Metrics::counters.iHookArenaBytes.load(std::memory_order_relaxed);
+    payload.iGatedHooks = Metrics::counters.iGatedHooks.load(std::memory_order_relaxed);
+    payload.iHeapAllocations = Metrics::counters.iHeapAllocations.load(std::memory_order_relaxed);
+    payload.iHeapFrees = Metrics::counters.iHeapFrees.load(std::memory_order_relaxed);
+    payload.iHeapCommittedBytes = Metrics::counters.iHeapCommittedBytes.load(std::memory_order_relaxed);
+    payload.iFileCacheBytes = Metrics::counters.iFileCacheBytes.load(std::memory_order_relaxed);
+    Metrics::Publish(payload);
+}
+
 void Framerate()
 {
-    if (fFramerateCap != 60.00f) {
+    if (fFramerateCap != 60.00f || bTimeline || bBenchmark || bMetrics) {
         // Framerate Cap
-        uint8_t* FramerateCapScanResult = Memory::PatternScan(baseModule, "F3 0F ?? ?? 0F ?? ?? 0F ?? ?? 76 ?? F3 0F ?? ?? ?? ?? ?? ?? F3 ?? ?? ?? ?? 83 ?? 01");
+        uint8_t* FramerateCapScanResult = FindSignature(Signatures::FramerateCap);
         if (FramerateCapScanResult) {
             spdlog::info("Framerate: Cap: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)FramerateCapScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid FramerateCapMidHook{};
-            FramerateCapMidHook = safetyhook::create_mid(FramerateCapScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm1.f32[0] = 1.00f / fFramerateCap;
-                });
+            if (bTimeline || bBenchmark || bMetrics) {
+                // The frame cap check runs once per frame, so it doubles as the timeline/benchmark/metrics frame boundary
+                static SafetyHookMid FramerateCapMidHook{};
+                FramerateCapMidHook = HookArena::CreateMid(FramerateCapScanResult,
+                    [](SafetyHookContext& ctx) {
+                        Timeline::Frame();
+                        Timeline::Scope scope("Framerate: Cap");
+                        Benchmark::Frame();
+                        if (bMetrics && Metrics::block.load(std::memory_order_relaxed))
+                            MetricsFrame();
+                        if (fFramerateCap != 60.00f)
+                            ctx.xmm1.f32[0] = 1.00f / fFramerateCap;
+                    });
+            }
+            else {
+                static LightHook FramerateCapHook{};
+                FramerateCapHook = LightHook::CreateXmm(FramerateCapScanResult, 1, 1.00f / fFramerateCap);
+            }
         }
         else if (!FramerateCapScanResult) {
             spdlog::error("Framerate: Cap: Pattern scan failed.");
         }
+    }
 
+    // Adaptive game speed needs the game speed and frametime hooks even at the game's own 60fps cap
+    if (fFramerateCap != 60.00f || bAdaptiveGameSpeed) {
         // Game Speed
-        uint8_t* GameSpeedScanResult = Memory::PatternScan(baseModule, "0F ?? ?? F3 0F ?? ?? F3 0F ?? ?? 0F ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? 0F ?? ?? 72 ??");
+        fGameSpeedStep = 1.00f / fFramerateCap;
+        static LightHook GameSpeedHook{};
+        uint8_t* GameSpeedScanResult = FindSignature(Signatures::GameSpeed);
         if (GameSpeedScanResult) {
             spdlog::info("Framerate: Game Speed: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)GameSpeedScanResult - (uintptr_t)baseModule);
-            static SafetyHookMid GameSpeedMidHook{};
-            GameSpeedMidHook = safetyhook::create_mid(GameSpeedScanResult,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm3.f32[0] = 1.00f / fFramerateCap;
-                });
+            if (bTimeline) {
+                static SafetyHookMid GameSpeedMidHook{};
+                GameSpeedMidHook = HookArena::CreateMid(GameSpeedScanResult,
+                    Benchmark::Gate(Benchmark::Group::Framerate, [](SafetyHookContext& ctx) {
+                        Timeline::Instant("Framerate: Game Speed");
+                        ctx.xmm3.f32[0] = fGameSpeedStep;
+                    }));
+            }
+            else {
+                GameSpeedHook = LightHook::CreateXmm(GameSpeedScanResult, 3, fGameSpeedStep);
+                Benchmark::Track(Benchmark::Group::Framerate, GameSpeedHook);
+            }
         }
         else if (!GameSpeedScanResult) {
             spdlog::error("Framerate: Game Speed: Pattern scan failed.");
         }
 
         // Get current frametime
-        uint8_t* CurrentFrametimeScanResult = Memory::PatternScan(baseModule, "66 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? 0F ?? ?? 72 ?? F3 0F ?? ?? ??");
+        uint8_t* CurrentFrametimeScanResult = FindSignature(Signatures::CurrentFrametime);
         if (CurrentFrametimeScanResult) {
             spdlog::info("Framerate: Frametime: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)CurrentFrametimeScanResult - (uintptr_t)baseModule);
             static SafetyHookMid CurrentFrametimeMidHook{};
-            CurrentFrametimeMidHook = safetyhook::create_mid(CurrentFrametimeScanResult,
-                [](SafetyHookContext& ctx) {
-                    fCurrentFrametime = ctx.xmm4.f32[0];
-                });
+            CurrentFrametimeMidHook = HookArena::CreateMid(CurrentFrametimeScanResult,
+                Benchmark::Gate(Benchmark::Group::Framerate, [](SafetyHookContext& ctx) {
+                    Timeline::Scope scope("Framerate: Frametime");
+                    Capture::Run<Capture::Site::CurrentFrametime>(ctx);
+
+                    // Step the game by the measured frametime so it doesn't slow down below the cap
+                    if (bAdaptiveGameSpeed) {
+                        fGameSpeedStep = Handlers::AdaptiveGameSpeedStep(fGameSpeedStep, fCurrentFrametime);
+                        GameSpeedHook.Set(fGameSpeedStep);
+                    }
+                }));
         }
         else if (!CurrentFrametimeScanResult) {
             spdlog::error("Framerate: Frametime: Pattern scan failed.");
         }
+    }
 
+    if (fFramerateCap != 60.00f) {
         // Input Speed
-        uint8_t* ControllerInputSpeedScanResult = Memory::PatternScan(baseModule, "41 0F ?? ?? 41 ?? ?? 41 ?? ?? 3C ?? 72 ?? 8B ?? 09 ?? ??");
-        uint8_t* KeyboardInputSpeedScanResult = Memory::PatternScan(baseModule, "F3 ?? ?? ?? ?? E8 ?? ?? ?? ?? 41 ?? ?? 48 ?? ?? ?? ?? ?? ?? 8B ?? 85 ?? 74 ?? FF ??");
+        uint8_t* ControllerInputSpeedScanResult = FindSignature(Signatures::ControllerInputSpeed);
+        uint8_t* KeyboardInputSpeedScanResult = FindSignature(Signatures::KeyboardInputSpeed);
         if (ControllerInputSpeedScanResult && KeyboardInputSpeedScanResult) {
             spdlog::info("Framerate: Input Speed: Controller: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ControllerInputSpeedScanResult - (uintptr_t)baseModule);
             static SafetyHookMid ControllerInputSpeedMidHook{};
 
-            static uintptr_t Target1Addr = (uintptr_t)ControllerInputSpeedScanResult + 0x16;
-            static uintptr_t Target2Addr = (uintptr_t)ControllerInputSpeedScanResult + 0x1A;
+            // Input targets are rewritten every call, so make them writable once instead of on each write
+            Handlers::ControllerInputTarget1 = ControllerInputSpeedScanResult + 0x16;
+            Handlers::ControllerInputTarget2 = ControllerInputSpeedScanResult + 0x1A;
+            DWORD oldProtect;
+            VirtualProtect(Handlers::ControllerInputTarget1, 0x5, PAGE_EXECUTE_READWRITE, &oldProtect);
 
-            ControllerInputSpeedMidHook = safetyhook::create_mid(ControllerInputSpeedScanResult + 0xC,
-                [](SafetyHookContext& ctx) {
-                    // Get current count
-                    int iCurrentCount = (int)ctx.rax;
-
-                    // Get current framerate
-                    int iCurrentFramerate = static_cast<int>(1.00f / fCurrentFrametime);
-
-                    // Calculate new target count by assuming it is 20 for 60fps
-                    int iTarget = static_cast<int>(20.00f * ((float)iCurrentFramerate / 60.00f));
-
-                    // Alter other targets
-                    if (Target1Addr && Target2Addr) {
-                        int iAltTarget = static_cast<int>(16.00f * ((float)iCurrentFramerate / 60.00f));
-                        Memory::Write((uintptr_t)Target1Addr, (BYTE)iAltTarget);
-                        Memory::Write((uintptr_t)Target2Addr, (BYTE)iAltTarget);
-                    }
-
-                    // Check if current count exceeds the target
-                    if (iCurrentCount < iTarget)
-                        ctx.rflags |= (1 << 0);     // Set CF
-                    else
-                        ctx.rflags &= ~(1 << 0);    // Clear CF
-                });
+            ControllerInputSpeedMidHook = HookArena::CreateMid(ControllerInputSpeedScanResult + 0xC,
+                Benchmark::Gate(Benchmark::Group::Framerate, [](SafetyHookContext& ctx) {
+                    Timeline::Scope scope("Input: Controller");
+                    Capture::Run<Capture::Site::ControllerInputSpeed>(ctx);
+                }));
 
             spdlog::info("Framerate: Input Speed: Keyboard: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)KeyboardInputSpeedScanResult - (uintptr_t)baseModule);
             static SafetyHookMid KeyboardInputSpeedMidHook{};
-            KeyboardInputSpeedMidHook = safetyhook::create_mid(KeyboardInputSpeedScanResult + 0x5,
-                [](SafetyHookContext& ctx) {
-                    ctx.xmm1.f32[0] = 1.00f / ((1.00f / fCurrentFrametime) / 60.00f);
-                });
+            KeyboardInputSpeedMidHook = HookArena::CreateMid(KeyboardInputSpeedScanResult + 0x5,
+                Benchmark::Gate(Benchmark::Group::Framerate, [](SafetyHookContext& ctx) {
+                    Timeline::Scope scope("Input: Keyboard");
+                    Capture::Run<Capture::Site::KeyboardInputSpeed>(ctx);
+                }));
         }
         else if (!ControllerInputSpeedScanResult || !KeyboardInputSpeedScanResult) {
             spdlog::error("Framerate: Input Speed: Pattern scan(s) failed.");
@@ -947,11 +1893,11 @@ void Framerate()
 void Misc()
 {
     // Disable Windows 7 compatibility message on startup
-    uint8_t* WindowsCompatibilityMessageScanResult = Memory::PatternScan(baseModule, "85 ?? 0F 84 ?? ?? ?? ?? 83 3D ?? ?? ?? ?? 00 75 ?? 48 ?? ?? ?? ?? ?? ?? 33 ??");
+    uint8_t* WindowsCompatibilityMessageScanResult = FindSignature(Signatures::WindowsCompatibilityMessage);
     if (WindowsCompatibilityMessageScanResult) {
         spdlog::info("Windows Compatibility Message: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)WindowsCompatibilityMessageScanResult - (uintptr_t)baseModule);
         static SafetyHookMid WinCompCheckMidHook{};
-        WinCompCheckMidHook = safetyhook::create_mid(WindowsCompatibilityMessageScanResult,
+        WinCompCheckMidHook = HookArena::CreateMid(WindowsCompatibilityMessageScanResult,
             [](SafetyHookContext& ctx) {
                 ctx.rax = 0;
             });
@@ -962,11 +1908,11 @@ void Misc()
 
     if (iShadowResolution != 4096) {
         // Shadow Quality 
-        uint8_t* ShadowQualityScanResult = Memory::PatternScan(baseModule, "C6 ?? ?? ?? ?? 33 ?? 41 ?? 01 00 00 00 89 ?? ?? ??");
+        uint8_t* ShadowQualityScanResult = FindSignature(Signatures::ShadowQuality);
         if (ShadowQualityScanResult) {
             spdlog::info("Shadow Quality: Address is {:s}+{:x}", sExeName.c_str(), (uintptr_t)ShadowQualityScanResult - (uintptr_t)baseModule);
             static SafetyHookMid WinCompCheckMidHook{};
-            WinCompCheckMidHook = safetyhook::create_mid(ShadowQualityScanResult,
+            WinCompCheckMidHook = HookArena::CreateMid(ShadowQualityScanResult, Benchmark::Gate(Benchmark::Group::Shadows,
                 [](SafetyHookContext& ctx) {
                     // If shadows are set to high
                     if (ctx.rax == 0x1000) {
@@ -974,7 +1920,7 @@ void Misc()
                         ctx.rax = iShadowResolution;
                         ctx.rdx = iShadowResolution;
                     }
-                });
+                }));
         }
         else if (!ShadowQualityScanResult) {
             spdlog::error("Shadow Quality: Pattern scan failed.");
@@ -982,16 +1928,316 @@ void Misc()
     }
 }
 
+DWORD __stdcall ThreadSchedulingThread(void*)
+{
+    Scheduler::Topology topology = Scheduler::QueryTopology();
+    spdlog::info("Thread Scheduling: P-core mask = {:x}, E-core mask = {:x}", topology.iPerformanceMask, topology.iEfficiencyMask);
+
+    DWORD_PTR iProcessMask = 0;
+    DWORD_PTR iSystemMask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &iProcessMask, &iSystemMask);
+
+    auto dosHeader = (PIMAGE_DOS_HEADER)baseModule;
+    auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)baseModule + dosHeader->e_lfanew);
+    size_t iModuleSize = ntHeaders->OptionalHeader.SizeOfImage;
+
+    std::set<Scheduler::ThreadKey> appliedThreads{};
+    while (true) {
+        // Let the game spin up its threads first, then keep picking up new ones
+        Sleep(iThreadRecheckInterval * 1000);
+
+        auto threads = Scheduler::EnumerateThreads();
+        auto classes = Scheduler::Classify(threads, (uintptr_t)baseModule, iModuleSize, iRenderThreadRVA);
+        for (size_t i : Scheduler::Untracked(threads, classes, appliedThreads)) {
+            if (Scheduler::ApplyPolicy(threads[i].iThreadId, ThreadPolicies[(int)classes[i]], topology, iProcessMask))
+                spdlog::info("Thread Scheduling: Applied {} policy to thread {} ({:s}+{:x})", Scheduler::ThreadClassName(classes[i]), threads[i].iThreadId, sExeName.c_str(), threads[i].iStartAddress - (uintptr_t)baseModule);
+        }
+    }
+    return true;
+}
+
+DWORD __stdcall TimelineThread(void*)
+{
+    bool bCapture = bTimelineCaptureOnStartup;
+    int iCaptureCount = 0;
+    while (true) {
+        if (GetAsyncKeyState(iTimelineHotkey) & 0x8000) {
+            bCapture = true;
+            // Wait for key release
+            while (GetAsyncKeyState(iTimelineHotkey) & 0x8000)
+                Sleep(10);
+        }
+
+        if (bCapture) {
+            bCapture = false;
+            if (Timeline::Start(fTimelineDuration, fTimelineLongFrame / fFramerateCap)) {
+                spdlog::info("Timeline Capture: Recording for {} seconds.", fTimelineDuration);
+                Sleep(static_cast<DWORD>(fTimelineDuration * 1000.00f));
+                Timeline::Stop();
+
+                // Give in-flight hook events time to land
+                Sleep(100);
+
+                std::filesystem::path tracePath = sThisModulePath / (sFixName + "_trace_" + std::to_string(iCaptureCount++) + ".json");
+                if (Timeline::Write(tracePath))
+                    spdlog::info("Timeline Capture: Wrote {} ({} events, {} dropped, {} long frames)", tracePath.string(), std::min(Timeline::iEventCount.load(), Timeline::iMaxEvents), Timeline::DroppedEvents(), Timeline::iLongFrames);
+                else
+                    spdlog::error("Timeline Capture: Failed to write {}", tracePath.string());
+            }
+        }
+
+        Sleep(50);
+    }
+    return true;
+}
+
+// Handlers can be handed pointers the game is about to free, don't let the capture copy take the game down
+bool SafeReadMemory(void* destination, const void* source, size_t iSize)
+{
+    __try {
+        memcpy(destination, source, iSize);
+        return true;
+    }
+    __except (GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+        return false;
+    }
+}
+
+DWORD __stdcall HookCaptureThread(void*)
+{
+    int iCaptureCount = 0;
+    while (true) {
+        if (GetAsyncKeyState(iHookCaptureHotkey) & 0x8000) {
+            // Wait for key release
+            while (GetAsyncKeyState(iHookCaptureHotkey) & 0x8000)
+                Sleep(10);
+
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            if (Capture::Start(fHookCaptureDuration, frequency.QuadPart)) {
+                spdlog::info("Hook Capture: Recording for {} seconds.", fHookCaptureDuration);
+                Sleep(static_cast<DWORD>(fHookCaptureDuration * 1000.00f));
+                Capture::Stop();
+
+                // Give in-flight records time to land
+                Sleep(100);
+
+                std::filesystem::path capturePath = sThisModulePath / (sFixName + "_capture_" + std::to_string(iCaptureCount++) + ".bin");
+                if (Capture::Write(capturePath.string()))
+                    spdlog::info("Hook Capture: Wrote {} ({} records, {} dropped)", capturePath.string(), Capture::RecordCount(), Capture::DroppedRecords());
+                else
+                    spdlog::error("Hook Capture: Failed to write {}", capturePath.string());
+            }
+        }
+
+        Sleep(50);
+    }
+    return true;
+}
+
+DWORD __stdcall LayoutThread(void*)
+{
+    while (WaitForSingleObject(Layout::hResized, INFINITE) == WAIT_OBJECT_0) {
+        // Let a window drag or display mode switch settle so only the final size is published
+        Sleep(100);
+
+        int iResX = 0;
+        int iResY = 0;
+        if (!Layout::Take(iResX, iResY) || (iResX == iCurrentResX && iResY == iCurrentResY))
+            continue;
+
+        spdlog::info("Live Resize: Resolution changed from {}x{} to {}x{}.", iCurrentResX, iCurrentResY, iResX, iResY);
+        iCurrentResX = iResX;
+        iCurrentResY = iResY;
+        CalculateAspectRatio(true);
+        size_t iBindings = Layout::Publish();
+        spdlog::info("Live Resize: Updated {} hooks.", iBindings);
+    }
+    return true;
+}
+
+DWORD __stdcall MetricsThread(void*)
+{
+    // Values that don't change per frame are gathered here, off the game thread
+    Metrics::counters.iHookArenaBytes = static_cast<uint32_t>(HookArena::Used());
+    Metrics::counters.iGatedHooks = static_cast<uint32_t>(Benchmark::iGatedHookCount);
+    while (true) {
+        Metrics::counters.iHeapAllocations = HeapAllocator::stats.iAllocations.load();
+        Metrics::counters.iHeapFrees = HeapAllocator::stats.iFrees.load();
+        Metrics::counters.iHeapCommittedBytes = HeapAllocator::CommittedBytes();
+        Metrics::counters.iFileCacheBytes = FileCache::CachedBytes();
+        Sleep(1000);
+    }
+    return true;
+}
+
+DWORD __stdcall BenchmarkThread(void*)
+{
+    int iSession = 0;
+    while (true) {
+        if (GetAsyncKeyState(iBenchmarkHotkey) & 0x8000) {
+            // Wait for key release
+            while (GetAsyncKeyState(iBenchmarkHotkey) & 0x8000)
+                Sleep(10);
+
+            // With a custom cap, switching Framerate off would keep rendering at the cap while the game steps at 1/60,
+            // so that variant would simulate at a different speed and not be comparable
+            uint32_t iSkippedGroups = 0;
+            if (fFramerateCap != 60.00f) {
+                iSkippedGroups |= 1u << static_cast<uint32_t>(Benchmark::Group::Framerate);
+                spdlog::info("Benchmark: Framerate cap is {}, the Framerate group stays on for every variant.", fFramerateCap);
+            }
+
+            auto variants = Benchmark::Variants(iSkippedGroups);
+            spdlog::info("Benchmark: Starting session with {} variants, {} round(s) of {} seconds each.", variants.size(), iBenchmarkRounds, fBenchmarkDuration);
+
+            // Variants are interleaved so drift over the session (heat, streaming, scene changes) spreads across all of them
+            std::map<std::string, std::vector<float>> frameTimes{};
+            for (int iRound = 0; iRound < iBenchmarkRounds; iRound++) {
+                for (const auto& variant : variants) {
+                    Benchmark::ApplyVariant(variant);
+
+                    // Let the toggle settle before recording
+                    Sleep(1000);
+                    Benchmark::Start();
+                    Sleep(static_cast<DWORD>(fBenchmarkDuration * 1000.00f));
+                    auto samples = Benchmark::Stop();
+                    spdlog::info("Benchmark: Round {}: {}: {} frames.", iRound + 1, variant.sName, samples.size());
+                    frameTimes[variant.sName].insert(frameTimes[variant.sName].end(), samples.begin(), samples.end());
+                }
+            }
+            Benchmark::ApplyVariant(variants[0]);
+
+            std::map<std::string, Benchmark::Stats> results{};
+            for (const auto& [sName, samples] : frameTimes)
+                results[sName] = Benchmark::Summarize(samples);
+
+            std::filesystem::path baselinePath = sThisModulePath / (sFixName + "_benchmark_baseline.txt");
+            auto baseline = Benchmark::ReadBaseline(baselinePath);
+
+            std::filesystem::path reportPath = sThisModulePath / (sFixName + "_benchmark_" + std::to_string(iSession++) + ".txt");
+            if (Benchmark::WriteReport(reportPath, variants, results, baseline))
+                spdlog::info("Benchmark: Wrote {}", reportPath.string());
+            else
+                spdlog::error("Benchmark: Failed to write {}", reportPath.string());
+
+            if (baseline.empty() || bBenchmarkUpdateBaseline) {
+                if (Benchmark::WriteBaseline(baselinePath, results))
+                    spdlog::info("Benchmark: Saved baseline to {}", baselinePath.string());
+                else
+                    spdlog::error("Benchmark: Failed to write {}", baselinePath.string());
+            }
+        }
+
+        Sleep(50);
+    }
+    return true;
+}
+
+void LiveResize()
+{
+    if (bLiveResize) {
+        Layout::hResized = CreateEventW(NULL, FALSE, FALSE, NULL);
+        if (!Layout::hResized) {
+            spdlog::error("Live Resize: Failed to create event.");
+            return;
+        }
+
+        // The window may already have been resized before the thread was up
+        if (Layout::iPendingSize.load())
+            SetEvent(Layout::hResized);
+
+        HANDLE layoutHandle = CreateThread(NULL, 0, LayoutThread, 0, NULL, 0);
+        if (layoutHandle) {
+            CloseHandle(layoutHandle);
+        }
+    }
+}
+
+void MetricsExport()
+{
+    if (bMetrics) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        if (!Metrics::Create(GetCurrentProcessId(), frequency.QuadPart)) {
+            spdlog::error("Metrics: Failed to create shared memory mapping ({}).", GetLastError());
+            return;
+        }
+        spdlog::info("Metrics: Publishing {} bytes (version {}) to Local\\BerserkFix_Metrics.", sizeof(Metrics::Block), Metrics::iVersion);
+
+        HANDLE metricsHandle = CreateThread(NULL, 0, MetricsThread, 0, NULL, 0);
+        if (metricsHandle) {
+            CloseHandle(metricsHandle);
+        }
+    }
+}
+
+void BenchmarkMode()
+{
+    if (bBenchmark) {
+        HANDLE benchmarkHandle = CreateThread(NULL, 0, BenchmarkThread, 0, NULL, 0);
+        if (benchmarkHandle) {
+            CloseHandle(benchmarkHandle);
+        }
+    }
+}
+
+void TimelineCapture()
+{
+    if (bTimeline) {
+        HANDLE timelineHandle = CreateThread(NULL, 0, TimelineThread, 0, NULL, 0);
+        if (timelineHandle) {
+            CloseHandle(timelineHandle);
+        }
+    }
+}
+
+void HookCapture()
+{
+    if (bHookCapture) {
+        Capture::ReadMemory = SafeReadMemory;
+        HANDLE captureHandle = CreateThread(NULL, 0, HookCaptureThread, 0, NULL, 0);
+        if (captureHandle) {
+            CloseHandle(captureHandle);
+        }
+    }
+}
+
+void ThreadScheduling()
+{
+    if (bThreadScheduling) {
+        HANDLE schedulingHandle = CreateThread(NULL, 0, ThreadSchedulingThread, 0, NULL, 0);
+        if (schedulingHandle) {
+            CloseHandle(schedulingHandle);
+        }
+    }
+}
+
 DWORD __stdcall Main(void*)
 {
     Logging();
     Configuration();
+    LoadScanCache();
+    LoadPrePatch();
+    ReserveHookArena();
+    HeapRedirect();
+    FileCaching();
     WindowManagement();
+    FlipModel();
     Resolution();
     AspectFOV();
     HUD();
     Framerate();
     Misc();
+    SaveScanCache();
+    HookArenaUsage();
+    SymbolMapExport();
+    ThreadScheduling();
+    TimelineCapture();
+    HookCapture();
+    BenchmarkMode();
+    LiveResize();
+    MetricsExport();
     return true;
 }
 
@@ -1012,8 +2258,12 @@ BOOL APIENTRY DllMain(HMODULE hModule,
         }
         break;
     }
-    case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
+        // Hand this thread's cached blocks back so other threads can reuse them
+        if (bHeapAllocator)
+            HeapAllocator::FlushThreadCache();
+        break;
+    case DLL_THREAD_ATTACH:
     case DLL_PROCESS_DETACH:
         break;
     }
@@ -0,0 +1,477 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Read-ahead and block cache for the game's archive files.
+// Every tracked archive gets a second handle owned by the cache. Reads through a game handle are checked against the
+// previous read on that handle, and once a handle reads sequentially the next ReadAhead bytes are fetched in one large
+// read on a worker thread. Small reads are served from fixed-size blocks kept in an LRU cache with a byte budget, and
+// misses pull in the whole block synchronously. Optionally an archive is mapped whole and reads are copied from the view.
+// Blocks are keyed by path so they survive the game closing and reopening an archive.
+// No Windows headers beyond the file calls, so tools/filecachebench can build and test it on Linux.
+namespace FileCache
+{
+    inline constexpr size_t iBlockSize = 256 * 1024;
+    inline constexpr uint32_t iSequentialReads = 2;     // Sequential reads on a handle before read-ahead kicks in
+
+#ifdef _WIN32
+    using NativeHandle = HANDLE;
+    inline const NativeHandle InvalidHandle = INVALID_HANDLE_VALUE;
+#else
+    using NativeHandle = int;
+    inline const NativeHandle InvalidHandle = -1;
+#endif
+
+    struct FileStats {
+        std::atomic<uint64_t> iReads = 0;
+        std::atomic<uint64_t> iHits = 0;            // Served entirely from cached blocks or the mapped view
+        std::atomic<uint64_t> iMisses = 0;          // Served after pulling in at least one block
+        std::atomic<uint64_t> iPassthrough = 0;     // Left to the original read (large, past the end or failed)
+        std::atomic<uint64_t> iBytesServed = 0;
+        std::atomic<uint64_t> iReadAheadBytes = 0;
+    };
+
+    struct File {
+        std::string sPath;
+        uint32_t iId = 0;
+        uint64_t iSize = 0;
+        NativeHandle handle = InvalidHandle;
+        const uint8_t* view = nullptr;
+#ifdef _WIN32
+        HANDLE mapping = NULL;
+#endif
+        uint32_t iOpenCount = 0;
+        FileStats stats{};
+
+        ~File();
+    };
+
+    // Per game handle
+    struct Stream {
+        std::shared_ptr<File> file;
+        std::mutex mutex{};
+        uint64_t iNextOffset = 0;
+        uint32_t iRun = 0;
+        uint64_t iReadAheadBlock = 0;   // First block not yet requested by read-ahead
+    };
+
+    struct Settings {
+        size_t iBudget = 512ull * 1024 * 1024;
+        size_t iReadAhead = 8ull * 1024 * 1024;
+        bool bMemoryMap = false;
+    };
+
+    inline Settings settings{};
+
+    // Block cache
+    using BlockData = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Block {
+        BlockData data;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    inline std::mutex cacheMutex{};
+    inline std::unordered_map<uint64_t, Block> blocks{};
+    inline std::list<uint64_t> lru{};             // Most recently used first
+    inline size_t iCachedBytes = 0;
+
+    // Open files by path, ids stay assigned for the lifetime of the process
+    inline std::mutex filesMutex{};
+    inline std::map<std::string, std::shared_ptr<File>> files{};
+    inline std::map<std::string, std::pair<uint32_t, uint64_t>> fileIds{};  // Path -> id, size when last opened
+
+    // Read-ahead worker
+    struct ReadAheadRequest {
+        std::shared_ptr<File> file;
+        uint64_t iFirstBlock;
+        uint64_t iBlockCount;
+    };
+
+    inline std::mutex queueMutex{};
+    inline std::condition_variable queueSignal{};
+    inline std::deque<ReadAheadRequest> queue{};
+    inline bool bWorkerRunning = false;
+    inline bool bWorkerExited = false;
+
+    inline uint64_t BlockKey(uint32_t iFileId, uint64_t iBlock)
+    {
+        return (uint64_t(iFileId) << 40) | iBlock;
+    }
+
+    // Platform
+    inline size_t ReadAt(NativeHandle handle, uint64_t iOffset, void* buffer, size_t iSize)
+    {
+#ifdef _WIN32
+        size_t iTotal = 0;
+        while (iTotal < iSize) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(iOffset + iTotal);
+            overlapped.OffsetHigh = static_cast<DWORD>((iOffset + iTotal) >> 32);
+            DWORD iChunk = static_cast<DWORD>(std::min<size_t>(iSize - iTotal, 0x40000000));
+            DWORD iRead = 0;
+            if (!ReadFile(handle, static_cast<uint8_t*>(buffer) + iTotal, iChunk, &iRead, &overlapped) || iRead == 0)
+                break;
+            iTotal += iRead;
+        }
+        return iTotal;
+#else
+        size_t iTotal = 0;
+        while (iTotal < iSize) {
+            ssize_t iRead = pread(handle, static_cast<uint8_t*>(buffer) + iTotal, iSize - iTotal, static_cast<off_t>(iOffset + iTotal));
+            if (iRead <= 0)
+                break;
+            iTotal += static_cast<size_t>(iRead);
+        }
+        return iTotal;
+#endif
+    }
+
+    inline void CloseNative(NativeHandle handle)
+    {
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        close(handle);
+#endif
+    }
+
+    inline bool MapFile(File& file)
+    {
+        if (file.iSize == 0)
+            return false;
+#ifdef _WIN32
+        file.mapping = CreateFileMappingW(file.handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!file.mapping)
+            return false;
+        file.view = static_cast<const uint8_t*>(MapViewOfFile(file.mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!file.view) {
+            CloseHandle(file.mapping);
+            file.mapping = NULL;
+            return false;
+        }
+#else
+        void* view = mmap(nullptr, file.iSize, PROT_READ, MAP_SHARED, file.handle, 0);
+        if (view == MAP_FAILED)
+            return false;
+        file.view = static_cast<const uint8_t*>(view);
+#endif
+        return true;
+    }
+
+    inline void UnmapFile(File& file)
+    {
+        if (!file.view)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(file.view);
+        CloseHandle(file.mapping);
+        file.mapping = NULL;
+#else
+        munmap(const_cast<uint8_t*>(file.view), file.iSize);
+#endif
+        file.view = nullptr;
+    }
+
+    // The read-ahead worker can outlive the game's handle, so the file goes with the last reference
+    inline File::~File()
+    {
+        UnmapFile(*this);
+        if (handle != InvalidHandle)
+            CloseNative(handle);
+    }
+
+    // Cache
+    inline BlockData Lookup(uint64_t iKey)
+    {
+        std::scoped_lock lock(cacheMutex);
+        auto it = blocks.find(iKey);
+        if (it == blocks.end())
+            return nullptr;
+
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second.data;
+    }
+
+    inline bool Contains(uint64_t iKey)
+    {
+        std::scoped_lock lock(cacheMutex);
+        return blocks.contains(iKey);
+    }
+
+    inline void Insert(uint64_t iKey, BlockData data)
+    {
+        std::scoped_lock lock(cacheMutex);
+        if (blocks.contains(iKey))
+            return;
+
+        while (!lru.empty() && iCachedBytes + data->size() > settings.iBudget) {
+            auto victim = blocks.find(lru.back());
+            iCachedBytes -= victim->second.data->size();
+            blocks.erase(victim);
+            lru.pop_back();
+        }
+
+        if (data->size() > settings.iBudget)
+            return;
+
+        lru.push_front(iKey);
+        iCachedBytes += data->size();
+        blocks[iKey] = { std::move(data), lru.begin() };
+    }
+
+    inline void Purge(uint32_t iFileId)
+    {
+        std::scoped_lock lock(cacheMutex);
+        for (auto it = lru.begin(); it != lru.end();) {
+            if ((*it >> 40) == iFileId) {
+                auto block = blocks.find(*it);
+                iCachedBytes -= block->second.data->size();
+                blocks.erase(block);
+                it = lru.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    inline size_t CachedBytes()
+    {
+        std::scoped_lock lock(cacheMutex);
+        return iCachedBytes;
+    }
+
+    // Reads iCount blocks in one request and splits them into the cache
+    inline bool FillBlocks(File& file, uint64_t iFirstBlock, uint64_t iCount)
+    {
+        uint64_t iOffset = iFirstBlock * iBlockSize;
+        if (iOffset >= file.iSize)
+            return false;
+
+        size_t iSize = static_cast<size_t>(std::min<uint64_t>(iCount * iBlockSize, file.iSize - iOffset));
+        std::vector<uint8_t> buffer(iSize);
+        size_t iRead = ReadAt(file.handle, iOffset, buffer.data(), iSize);
+        if (iRead != iSize)
+            return false;
+
+        for (size_t iStart = 0; iStart < iSize; iStart += iBlockSize) {
+            size_t iLength = std::min(iBlockSize, iSize - iStart);
+            Insert(BlockKey(file.iId, iFirstBlock + iStart / iBlockSize),
+                std::make_shared<const std::vector<uint8_t>>(buffer.begin() + iStart, buffer.begin() + iStart + iLength));
+        }
+        return true;
+    }
+
+    inline void Worker()
+    {
+        while (true) {
+            ReadAheadRequest request{};
+            {
+                std::unique_lock lock(queueMutex);
+                queueSignal.wait(lock, [] { return !queue.empty() || !bWorkerRunning; });
+                if (!bWorkerRunning) {
+                    bWorkerExited = true;
+                    queueSignal.notify_all();
+                    return;
+                }
+                request = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            // Skip blocks that were already pulled in by a miss, read every uncached run in one go
+            uint64_t iEnd = request.iFirstBlock + request.iBlockCount;
+            for (uint64_t iBlock = request.iFirstBlock; iBlock < iEnd;) {
+                if (Contains(BlockKey(request.file->iId, iBlock))) {
+                    iBlock++;
+                    continue;
+                }
+
+                uint64_t iRunEnd = iBlock + 1;
+                while (iRunEnd < iEnd && !Contains(BlockKey(request.file->iId, iRunEnd)))
+                    iRunEnd++;
+
+                if (FillBlocks(*request.file, iBlock, iRunEnd - iBlock))
+                    request.file->stats.iReadAheadBytes.fetch_add((iRunEnd - iBlock) * iBlockSize, std::memory_order_relaxed);
+                iBlock = iRunEnd;
+            }
+        }
+    }
+
+    // The worker is detached: the fix never calls Shutdown(), and a joinable static std::thread would call
+    // std::terminate() when the CRT destroys it at process exit.
+    inline void Initialize(const Settings& newSettings)
+    {
+        settings = newSettings;
+        if (bWorkerRunning || settings.iReadAhead == 0)
+            return;
+
+        bWorkerRunning = true;
+        bWorkerExited = false;
+        std::thread(Worker).detach();
+    }
+
+    inline void Shutdown()
+    {
+        {
+            std::scoped_lock lock(queueMutex);
+            if (!bWorkerRunning)
+                return;
+            bWorkerRunning = false;
+            queue.clear();
+        }
+        queueSignal.notify_all();
+
+        std::unique_lock lock(queueMutex);
+        queueSignal.wait(lock, [] { return bWorkerExited; });
+    }
+
+    inline void ScheduleReadAhead(Stream& stream, uint64_t iFromBlock)
+    {
+        if (!bWorkerRunning)
+            return;
+
+        File& file = *stream.file;
+        uint64_t iBlockCount = (file.iSize + iBlockSize - 1) / iBlockSize;
+        uint64_t iEnd = std::min(iFromBlock + settings.iReadAhead / iBlockSize, iBlockCount);
+        uint64_t iStart = std::max(iFromBlock, stream.iReadAheadBlock);
+
+        // Top up in half-window steps so each request stays large
+        if (iStart >= iEnd || (iStart > iFromBlock && iEnd < iBlockCount && iEnd - iStart < (settings.iReadAhead / iBlockSize) / 2))
+            return;
+
+        stream.iReadAheadBlock = iEnd;
+        {
+            std::scoped_lock lock(queueMutex);
+            queue.push_back({ stream.file, iStart, iEnd - iStart });
+        }
+        queueSignal.notify_one();
+    }
+
+    // Takes ownership of handle (a separate handle to the same file). Returns nullptr if the file can't be used.
+    inline std::shared_ptr<File> Open(const std::string& sPath, NativeHandle handle, uint64_t iSize)
+    {
+        std::scoped_lock lock(filesMutex);
+        if (auto it = files.find(sPath); it != files.end()) {
+            CloseNative(handle);
+            it->second->iOpenCount++;
+            return it->second;
+        }
+
+        auto file = std::make_shared<File>();
+        file->sPath = sPath;
+        file->iSize = iSize;
+        file->handle = handle;
+        file->iOpenCount = 1;
+
+        // Same path, different size: the archive was replaced, drop what we have of the old one
+        auto [id, bInserted] = fileIds.try_emplace(sPath, static_cast<uint32_t>(fileIds.size()), iSize);
+        file->iId = id->second.first;
+        if (!bInserted && id->second.second != iSize) {
+            Purge(file->iId);
+            id->second.second = iSize;
+        }
+
+        if (settings.bMemoryMap)
+            MapFile(*file);
+
+        files[sPath] = file;
+        return file;
+    }
+
+    // Returns the file if this was the last open handle to it, so the caller can report its statistics
+    inline std::shared_ptr<File> Close(const std::shared_ptr<File>& file)
+    {
+        std::scoped_lock lock(filesMutex);
+        if (--file->iOpenCount != 0)
+            return nullptr;
+
+        files.erase(file->sPath);
+        return file;
+    }
+
+    // Serves a read of iSize bytes at iOffset through stream. False if the caller should do the read itself.
+    inline bool Read(Stream& stream, uint64_t iOffset, void* buffer, size_t iSize, size_t& iRead)
+    {
+        File& file = *stream.file;
+        file.stats.iReads.fetch_add(1, std::memory_order_relaxed);
+
+        bool bSequential;
+        {
+            std::scoped_lock lock(stream.mutex);
+            bSequential = iOffset == stream.iNextOffset;
+            stream.iRun = bSequential ? stream.iRun + 1 : 0;
+            stream.iNextOffset = iOffset + iSize;
+            if (!bSequential)
+                stream.iReadAheadBlock = 0;
+            if (stream.iRun >= iSequentialReads && !file.view)
+                ScheduleReadAhead(stream, (iOffset + iSize + iBlockSize - 1) / iBlockSize);
+        }
+
+        if (iOffset >= file.iSize || iSize == 0) {
+            file.stats.iPassthrough.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        size_t iAvailable = static_cast<size_t>(std::min<uint64_t>(iSize, file.iSize - iOffset));
+        if (file.view) {
+            memcpy(buffer, file.view + iOffset, iAvailable);
+            file.stats.iHits.fetch_add(1, std::memory_order_relaxed);
+            file.stats.iBytesServed.fetch_add(iAvailable, std::memory_order_relaxed);
+            iRead = iAvailable;
+            return true;
+        }
+
+        // Large reads are already efficient, let them through
+        if (iAvailable > iBlockSize) {
+            file.stats.iPassthrough.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool bMissed = false;
+        uint8_t* output = static_cast<uint8_t*>(buffer);
+        for (uint64_t iPosition = iOffset; iPosition < iOffset + iAvailable;) {
+            uint64_t iBlock = iPosition / iBlockSize;
+            BlockData data = Lookup(BlockKey(file.iId, iBlock));
+            if (!data) {
+                bMissed = true;
+                if (!FillBlocks(file, iBlock, 1) || !(data = Lookup(BlockKey(file.iId, iBlock)))) {
+                    file.stats.iPassthrough.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+
+            size_t iBlockOffset = static_cast<size_t>(iPosition - iBlock * iBlockSize);
+            size_t iLength = static_cast<size_t>(std::min<uint64_t>(data->size() - iBlockOffset, iOffset + iAvailable - iPosition));
+            memcpy(output, data->data() + iBlockOffset, iLength);
+            output += iLength;
+            iPosition += iLength;
+        }
+
+        (bMissed ? file.stats.iMisses : file.stats.iHits).fetch_add(1, std::memory_order_relaxed);
+        file.stats.iBytesServed.fetch_add(iAvailable, std::memory_order_relaxed);
+        iRead = iAvailable;
+        return true;
+    }
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <safetyhook.hpp>
+
+// Mid-hook handlers.
+// These only touch the SafetyHookContext, the memory it points at and the globals below, so they can be called
+// with a synthetic context and fake stack/struct memory outside the game.
+
+// Owned by dllmain.cpp
+extern float fAspectRatio;
+extern float fNativeAspect;
+extern float fAspectMultiplier;
+extern float fHUDWidth;
+extern float fHUDHeight;
+extern float fHUDWidthOffset;
+extern float fHUDHeightOffset;
+extern float fGameplayFOVMulti;
+extern float fCurrentFrametime;
+extern float fFramerateCap;
+extern float fAdaptiveMinFramerate;
+extern float fAdaptiveSmoothing;
+extern int iCurrentResX;
+extern int iCurrentResY;
+
+namespace Handlers
+{
+    // Input speed targets patched by the controller input hook (immediates in game code, made writable on install)
+    inline uint8_t* ControllerInputTarget1 = nullptr;
+    inline uint8_t* ControllerInputTarget2 = nullptr;
+
+    // Rect in 1920x1080 UI space stored as { x, y, width, height }, expanded to cover the whole screen.
+    inline void ExpandBackgroundRect(float* rect)
+    {
+        if (fAspectRatio > fNativeAspect) {
+            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
+            rect[2] = 1080.00f * fAspectRatio;
+            rect[0] = -fWidthOffset;
+        }
+        else if (fAspectRatio < fNativeAspect) {
+            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
+            rect[3] = 1920.00f / fAspectRatio;
+            rect[1] = -fHeightOffset;
+        }
+    }
+
+    // Rect in 1920x1080 UI space stored as { left, top, right, bottom }, expanded to cover the whole screen.
+    inline void ExpandCaptureRect(float* rect)
+    {
+        if (fAspectRatio > fNativeAspect) {
+            float fWidthOffset = ((1080.00f * fAspectRatio) - 1920.00f) / 2.00f;
+            rect[2] = (1080.00f * fAspectRatio) - fWidthOffset;
+            rect[0] = -fWidthOffset;
+        }
+        else if (fAspectRatio < fNativeAspect) {
+            float fHeightOffset = ((1920.00f / fAspectRatio) - 1080.00f) / 2.00f;
+            rect[3] = (1920.00f / fAspectRatio) - fHeightOffset;
+            rect[1] = -fHeightOffset;
+        }
+    }
+
+    // AspectFOV()
+    inline void AspectRatio(SafetyHookContext& ctx)
+    {
+        if (ctx.rbx + 0x1B0) {
+            *reinterpret_cast<float*>(ctx.rbx + 0x1B0) = fAspectRatio;
+        }
+    }
+
+    inline void GlobalFOV(SafetyHookContext& ctx)
+    {
+        if (fAspectRatio < fNativeAspect)
+            ctx.xmm0.f32[0] = 2.00f * atanf(tanf(ctx.xmm0.f32[0] / 2.00f) * (fNativeAspect / fAspectRatio));
+    }
+
+    inline void GameplayFOV(SafetyHookContext& ctx)
+    {
+        ctx.xmm0.f32[0] *= fGameplayFOVMulti;
+    }
+
+    inline void GameplayLockOnFOV(SafetyHookContext& ctx)
+    {
+        ctx.xmm7.f32[0] *= fGameplayFOVMulti;
+    }
+
+    // HUD()
+    inline void FadeWidth(SafetyHookContext& ctx)
+    {
+        if (ctx.xmm2.f32[0] == 1920.00f) {
+            if (fAspectRatio > fNativeAspect) {
+                ctx.xmm0.f32[0] = -(((1080.00f * fAspectRatio) - 1920.00f) / 2.00f);
+                ctx.xmm2.f32[0] = 1080.00f * fAspectRatio;
+            }
+            else if (fAspectRatio < fNativeAspect) {
+                ctx.xmm1.f32[0] = -(((1920.00f / fAspectRatio) - 1080.00f) / 2.00f);
+            }
+        }
+    }
+
+    inline void FadeHeight(SafetyHookContext& ctx)
+    {
+        if (ctx.xmm2.f32[0] == 1920.00f) {
+            if (fAspectRatio < fNativeAspect)
+                ctx.xmm3.f32[0] = 1920.00f / fAspectRatio;
+        }
+    }
+
+    inline void PauseCapture(SafetyHookContext& ctx)
+    {
+        if (ctx.rsp + 0x50) {
+            ExpandCaptureRect(reinterpret_cast<float*>(ctx.rsp + 0x48));
+        }
+    }
+
+    inline void PauseBackground(SafetyHookContext& ctx)
+    {
+        if (ctx.rcx + 0x20 && ctx.xmm1.f32[0] == 1920.00f) {
+            if (fAspectRatio > fNativeAspect) {
+                ctx.xmm1.f32[0] = 1080.00f * fAspectRatio;
+                *reinterpret_cast<float*>(ctx.rcx + 0x20) = -((ctx.xmm1.f32[0] - 1920.00f) / 2.00f);
+            }
+            else if (fAspectRatio < fNativeAspect) {
+                ctx.xmm0.f32[0] = 1920.00f / fAspectRatio;
+                *reinterpret_cast<float*>(ctx.rcx + 0x24) = -((ctx.xmm0.f32[0] - 1080.00f) / 2.00f);
+            }
+        }
+    }
+
+    inline void MissionSelectCapture(SafetyHookContext& ctx)
+    {
+        if (ctx.rsp + 0x40 && ctx.xmm0.f32[0] == 1920.00f) {
+            ExpandCaptureRect(reinterpret_cast<float*>(ctx.rsp + 0x40));
+        }
+    }
+
+    inline void MissionSelectBackground(SafetyHookContext& ctx)
+    {
+        if (ctx.r8 + 0x20 && ctx.xmm1.f32[0] == 1920.00f) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.r8 + 0x20));
+        }
+    }
+
+    // Menu backgrounds are drawn in screen space, so this matches the render resolution. That's the one from the ini unless
+    // live resize picked up a new back buffer size (see LayoutThread).
+    inline void MenuBackgrounds(SafetyHookContext& ctx)
+    {
+        if (ctx.rsp + 0x50 && ctx.xmm0.f32[0] == (float)iCurrentResX && ctx.xmm1.f32[0] == (float)iCurrentResY) {
+            if (fAspectRatio > fNativeAspect) {
+                *reinterpret_cast<float*>(ctx.rsp + 0x58) = fHUDWidth + fHUDWidthOffset;
+                *reinterpret_cast<float*>(ctx.rsp + 0x50) = fHUDWidthOffset;
+            }
+            else if (fAspectRatio < fNativeAspect) {
+                *reinterpret_cast<float*>(ctx.rsp + 0x5C) = fHUDHeight + fHUDHeightOffset;
+                *reinterpret_cast<float*>(ctx.rsp + 0x54) = fHUDHeightOffset;
+            }
+        }
+    }
+
+    inline void HUDBackgrounds1(SafetyHookContext& ctx)
+    {
+        if (ctx.rdx + 0x20) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.rdx + 0x20));
+        }
+    }
+
+    inline void HUDBackgrounds2(SafetyHookContext& ctx)
+    {
+        if (ctx.rsp + 0x40) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.rsp + 0x40));
+        }
+    }
+
+    inline void HUDBackgrounds3(SafetyHookContext& ctx)
+    {
+        if (ctx.rdx + 0x20) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.rdx + 0x20));
+        }
+    }
+
+    inline void HUDBackgrounds4(SafetyHookContext& ctx)
+    {
+        if (ctx.rdx + 0x20) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.rdx + 0x20));
+        }
+    }
+
+    inline void HUDBackgrounds5(SafetyHookContext& ctx)
+    {
+        if (ctx.rsp + 0x30) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.rsp + 0x30));
+        }
+    }
+
+    inline void HUDBackgrounds6(SafetyHookContext& ctx)
+    {
+        if (ctx.r8 + 0x30) {
+            ExpandBackgroundRect(reinterpret_cast<float*>(ctx.r8 + 0x20));
+        }
+    }
+
+    // Framerate()
+    inline void CurrentFrametime(SafetyHookContext& ctx)
+    {
+        fCurrentFrametime = ctx.xmm4.f32[0];
+    }
+
+    // Next game speed step from the measured frametime. Clamped between the cap and the minimum framerate, then
+    // smoothed so a single hitch doesn't turn into one large physics step.
+    inline float AdaptiveGameSpeedStep(float fPreviousStep, float fFrametime)
+    {
+        float fMinStep = 1.00f / fFramerateCap;
+        float fMaxStep = 1.00f / fAdaptiveMinFramerate;
+        if (!(fFrametime > 0.00f))
+            fFrametime = fMinStep;
+
+        float fTarget = std::clamp(fFrametime, fMinStep, fMaxStep);
+        return std::clamp(fPreviousStep + (fTarget - fPreviousStep) * fAdaptiveSmoothing, fMinStep, fMaxStep);
+    }
+
+    inline void ControllerInputSpeed(SafetyHookContext& ctx)
+    {
+        // Get current count
+        int iCurrentCount = (int)ctx.rax;
+
+        // Get current framerate
+        int iCurrentFramerate = static_cast<int>(1.00f / fCurrentFrametime);
+
+        // Calculate new target count by assuming it is 20 for 60fps
+        int iTarget = static_cast<int>(20.00f * ((float)iCurrentFramerate / 60.00f));
+
+        // Alter other targets
+        if (ControllerInputTarget1 && ControllerInputTarget2) {
+            int iAltTarget = static_cast<int>(16.00f * ((float)iCurrentFramerate / 60.00f));
+            *ControllerInputTarget1 = (uint8_t)iAltTarget;
+            *ControllerInputTarget2 = (uint8_t)iAltTarget;
+        }
+
+        // Check if current count exceeds the target
+        if (iCurrentCount < iTarget)
+            ctx.rflags |= (1 << 0);     // Set CF
+        else
+            ctx.rflags &= ~(1 << 0);    // Clear CF
+    }
+
+    inline void KeyboardInputSpeed(SafetyHookContext& ctx)
+    {
+        ctx.xmm1.f32[0] = 1.00f / ((1.00f / fCurrentFrametime) / 60.00f);
+    }
+}
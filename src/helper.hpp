@@ -82,6 +82,13 @@ namespace Memory
         return ntHeaders->FileHeader.TimeDateStamp;
     }
 
+    uint32_t ModuleSize(void* module)
+    {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        return ntHeaders->OptionalHeader.SizeOfImage;
+    }
+
     uintptr_t GetAbsolute(uintptr_t address) noexcept
     {
         return (address + 4 + *reinterpret_cast<std::int32_t*>(address));
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <safetyhook.hpp>
+
+#include "symbolmap.hpp"
+
+// Hook arena for stubs and trampolines inside the game image.
+// One region near the game module is committed up front on a dedicated allocator and immediately released back to
+// that allocator's free list. Every later stub and trampoline is carved from it in install order, so game hooks share
+// a few pages (and their i-cache/iTLB entries) and hook setup doesn't probe the address space with VirtualQuery or
+// VirtualAlloc per hook. The end of the last carved block is tracked explicitly from each hook's own allocations,
+// nothing is allocated just to find it. When a region can't fit another hook, its tail is used up as padding and the
+// next region is reserved near the game the same way.
+namespace HookArena
+{
+    inline constexpr size_t iCacheLine = 64;
+
+    // Room one hook may need: safetyhook's 391-byte mid hook stub plus a trampoline of relocated instructions
+    inline constexpr size_t iMaxHookSize = 0x400;
+
+    // Falls back to safetyhook's global allocator until Reserve() succeeds
+    inline std::shared_ptr<safetyhook::Allocator> allocator = safetyhook::Allocator::global();
+    inline uint8_t* module = nullptr;
+    inline size_t iRegionSize = 0;
+    inline uintptr_t iBase = 0;                 // Current region
+    inline size_t iSize = 0;                    // Reserved over every region
+    inline uintptr_t iCursor = 0;               // End of the last block carved from the current region
+    inline size_t iRetired = 0;                 // Bytes used in earlier regions
+    inline std::atomic<size_t> iUsed = 0;       // Read by the metrics thread, only written while hooks are installed
+    inline std::vector<safetyhook::Allocation> padding{};
+
+    inline void Publish()
+    {
+        iUsed.store(iRetired + (iCursor - iBase), std::memory_order_relaxed);
+    }
+
+    inline bool Grow()
+    {
+        auto region = allocator->allocate_near({ module }, iRegionSize);
+        if (!region)
+            return false;
+
+        if (iBase)
+            iRetired += iRegionSize;
+        iBase = region->address();
+        iSize += region->size();
+        iCursor = iBase;
+        region->free();
+        Publish();
+        return true;
+    }
+
+    inline bool Reserve(void* gameModule, size_t iBytes)
+    {
+        allocator = safetyhook::Allocator::create();
+        module = reinterpret_cast<uint8_t*>(gameModule);
+        iRegionSize = iBytes;
+        if (!Grow()) {
+            allocator = safetyhook::Allocator::global();
+            return false;
+        }
+        return true;
+    }
+
+    // Bytes handed out so far
+    inline size_t Used()
+    {
+        return iUsed.load(std::memory_order_relaxed);
+    }
+
+    // Advances the cursor past a block the allocator handed out
+    inline void Track(uintptr_t iAddress, size_t iBytes)
+    {
+        if (iAddress >= iBase && iAddress + iBytes <= iBase + iRegionSize && iAddress + iBytes > iCursor) {
+            iCursor = iAddress + iBytes;
+            Publish();
+        }
+    }
+
+    // Keeps a block at the cursor for good, returns false if the allocator put it anywhere else
+    inline bool Pad(size_t iBytes)
+    {
+        auto pad = allocator->allocate_near({ module }, iBytes);
+        if (!pad || pad->address() != iCursor)
+            return false;
+
+        Track(pad->address(), pad->size());
+        padding.push_back(std::move(*pad));
+        return true;
+    }
+
+    // Makes sure the next hook fits in the current region and starts on its own cache line
+    inline void Prepare()
+    {
+        if (!iBase)
+            return;
+
+        size_t iRemaining = iBase + iRegionSize - iCursor;
+        if (iRemaining < iMaxHookSize) {
+            // Use up the tail so first-fit allocations can't land behind the cursor of the new region
+            if (iRemaining)
+                Pad(iRemaining);
+            if (!Grow())
+                return;
+        }
+
+        if (size_t iPad = (iCacheLine - (iCursor & (iCacheLine - 1))) & (iCacheLine - 1))
+            Pad(iPad);
+    }
+
+    // Any other block the fix places in the arena, kept near the game if the arena has to grow
+    inline std::expected<safetyhook::Allocation, safetyhook::Allocator::Error> Allocate(size_t iBytes)
+    {
+        if (!iBase)
+            return allocator->allocate(iBytes);
+
+        auto allocation = allocator->allocate_near({ module }, iBytes);
+        if (allocation)
+            Track(allocation->address(), allocation->size());
+        return allocation;
+    }
+
+    inline SafetyHookMid CreateMid(void* target, safetyhook::MidHookFn destination)
+    {
+        Prepare();
+        if (auto hook = safetyhook::MidHook::create(allocator, target, destination)) {
+            SymbolMap::Hook decoded{};
+            if (SymbolMap::DecodeMid(*hook, decoded)) {
+                Track(decoded.iTrampoline, decoded.iTrampolineSize);
+                Track(decoded.iStub, decoded.iStubSize);
+            }
+            SymbolMap::AddMid(*hook);
+            return std::move(*hook);
+        }
+        return {};
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Live resolution tracking.
+// The swapchain hooks only record the new back buffer size and signal the layout thread, which recomputes the derived
+// values and runs every binding. Bindings push the values into LightHook value slots and enable flags, so nothing is
+// reinstalled. Mid hooks read the globals directly and pick the new values up on their next hit.
+namespace Layout
+{
+    struct Values {
+        float fAspectRatio;
+        float fAspectMultiplier;
+        float fHUDWidth;
+        float fHUDHeight;
+        float fHUDWidthOffset;
+        float fHUDHeightOffset;
+    };
+
+    inline Values Calculate(int iResX, int iResY, float fNativeAspect)
+    {
+        Values values{};
+        values.fAspectRatio = (float)iResX / (float)iResY;
+        values.fAspectMultiplier = values.fAspectRatio / fNativeAspect;
+
+        // HUD is pillarboxed when wider than native, letterboxed when narrower
+        values.fHUDWidth = iResY * fNativeAspect;
+        values.fHUDHeight = (float)iResY;
+        values.fHUDWidthOffset = (float)(iResX - values.fHUDWidth) / 2;
+        values.fHUDHeightOffset = 0;
+        if (values.fAspectRatio < fNativeAspect) {
+            values.fHUDWidth = (float)iResX;
+            values.fHUDHeight = (float)iResX / fNativeAspect;
+            values.fHUDWidthOffset = 0;
+            values.fHUDHeightOffset = (float)(iResY - values.fHUDHeight) / 2;
+        }
+        return values;
+    }
+
+    // Bindings
+    inline std::mutex bindingsMutex{};
+    inline std::vector<std::function<void()>> bindings{};
+
+    // Runs publish now and again after every resolution change
+    inline void Bind(std::function<void()> publish)
+    {
+        publish();
+        std::scoped_lock lock(bindingsMutex);
+        bindings.push_back(std::move(publish));
+    }
+
+    inline size_t Publish()
+    {
+        std::scoped_lock lock(bindingsMutex);
+        for (const auto& publish : bindings)
+            publish();
+        return bindings.size();
+    }
+
+    // Resize requests, latest size wins
+    inline std::atomic<uint64_t> iPendingSize = 0;
+    inline HANDLE hResized = NULL;
+
+    inline void Request(int iResX, int iResY)
+    {
+        if (iResX <= 0 || iResY <= 0)
+            return;
+
+        iPendingSize.store((uint64_t(uint32_t(iResX)) << 32) | uint32_t(iResY), std::memory_order_release);
+        if (hResized)
+            SetEvent(hResized);
+    }
+
+    inline bool Take(int& iResX, int& iResY)
+    {
+        uint64_t iSize = iPendingSize.exchange(0, std::memory_order_acquire);
+        if (!iSize)
+            return false;
+
+        iResX = static_cast<int>(iSize >> 32);
+        iResY = static_cast<int>(iSize & 0xFFFFFFFF);
+        return true;
+    }
+}
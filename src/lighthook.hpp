@@ -0,0 +1,191 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <bit>
+#include <vector>
+#include <safetyhook.hpp>
+
+#include "hookarena.hpp"
+#include "symbolmap.hpp"
+
+// Lightweight mid-function hook that loads a single value into one register.
+// A SafetyHookMid stub saves and restores every GPR and XMM register on each hit, which adds up for hooks that
+// fire per-entity or per-draw. A LightHook instead jumps into a tiny generated stub that only writes the target
+// register from a value slot and then continues into the trampoline. Flags and every other register are untouched.
+//
+// Stub layout:
+//   jmp [entry]          ; entry points at "apply" when enabled, or at "resume" when disabled
+//   apply:  <load value into register>
+//   wait:   pause
+//   resume: jmp [trampoline]
+//   entry, trampoline, value
+// The trampoline only exists once the game code is patched, so the trampoline slot starts out pointing at "wait".
+// A thread that reaches the hook before the slot is filled spins there instead of jumping to a null address.
+class LightHook {
+public:
+    enum class Register : uint8_t { Gpr32, Xmm };
+
+    LightHook() = default;
+    LightHook(const LightHook&) = delete;
+    LightHook(LightHook&& other) noexcept = default;
+    LightHook& operator=(const LightHook&) = delete;
+    LightHook& operator=(LightHook&& other) noexcept = default;
+
+    // Load a 32-bit value into a general purpose register (zero-extended to 64 bits). 0 = rax, 1 = rcx ... 15 = r15.
+    static LightHook CreateGpr32(void* target, uint8_t iRegister, uint32_t iValue)
+    {
+        return Create(target, Register::Gpr32, iRegister, iValue);
+    }
+
+    // Load a float into the low lane of an XMM register. The upper lanes are preserved.
+    static LightHook CreateXmm(void* target, uint8_t iRegister, float fValue)
+    {
+        return Create(target, Register::Xmm, iRegister, std::bit_cast<uint32_t>(fValue));
+    }
+
+    explicit operator bool() const { return static_cast<bool>(m_hook); }
+
+    void Set(uint32_t iValue)
+    {
+        if (m_stub)
+            reinterpret_cast<std::atomic<uint32_t>*>(m_stub.data() + m_valueOffset)->store(iValue, std::memory_order_relaxed);
+    }
+
+    void Set(float fValue)
+    {
+        Set(std::bit_cast<uint32_t>(fValue));
+    }
+
+    // Disabled hooks still run through the stub but skip the register write.
+    void Enable(bool bEnable)
+    {
+        if (m_stub) {
+            uintptr_t entry = m_stub.address() + (bEnable ? m_applyOffset : m_resumeOffset);
+            reinterpret_cast<std::atomic<uintptr_t>*>(m_stub.data() + m_entryOffset)->store(entry, std::memory_order_release);
+        }
+    }
+
+    bool IsEnabled() const
+    {
+        if (!m_stub)
+            return false;
+        return reinterpret_cast<const std::atomic<uintptr_t>*>(m_stub.data() + m_entryOffset)->load(std::memory_order_relaxed) == m_stub.address() + m_applyOffset;
+    }
+
+    uintptr_t TargetAddress() const { return m_hook.target_address(); }
+    uintptr_t StubAddress() const { return m_stub.address(); }
+    size_t StubSize() const { return m_stub.size(); }
+    const safetyhook::Allocation& Trampoline() const { return m_hook.trampoline(); }
+
+private:
+    SafetyHookInline m_hook{};
+    safetyhook::Allocation m_stub{};
+    size_t m_applyOffset{};
+    size_t m_resumeOffset{};
+    size_t m_entryOffset{};
+    size_t m_valueOffset{};
+
+    static void EmitRipRelative(std::vector<uint8_t>& code, size_t dispPos, size_t slotOffset)
+    {
+        // Displacement is relative to the end of the instruction, which always ends right after disp32 here.
+        int32_t disp = static_cast<int32_t>(slotOffset) - static_cast<int32_t>(dispPos + 4);
+        memcpy(code.data() + dispPos, &disp, sizeof(disp));
+    }
+
+    static LightHook Create(void* target, Register type, uint8_t iRegister, uint32_t iValue)
+    {
+        LightHook hook{};
+        if (iRegister > 15)
+            return hook;
+
+        std::vector<uint8_t> code{};
+        std::vector<std::pair<size_t, int>> fixups{}; // disp32 position, slot index (0 = entry, 1 = trampoline, 2 = value)
+
+        // jmp [rip+entry]
+        code.insert(code.end(), { 0xFF, 0x25, 0, 0, 0, 0 });
+        fixups.push_back({ code.size() - 4, 0 });
+        hook.m_applyOffset = code.size();
+
+        if (type == Register::Gpr32) {
+            // mov r32, [rip+value]
+            if (iRegister >= 8)
+                code.push_back(0x44);
+            code.insert(code.end(), { 0x8B, (uint8_t)(0x05 | ((iRegister & 7) << 3)), 0, 0, 0, 0 });
+            fixups.push_back({ code.size() - 4, 2 });
+        }
+        else {
+            // Merge into the low lane through a scratch register so the upper lanes survive.
+            uint8_t iScratch = (iRegister == 15) ? 14 : 15;
+            uint8_t iScratchModRM = (uint8_t)(((iScratch & 7) << 3) | 0x04);
+
+            code.insert(code.end(), { 0x48, 0x8D, 0x64, 0x24, 0xF0 });                          // lea rsp, [rsp-0x10]
+            code.insert(code.end(), { 0xF3, 0x44, 0x0F, 0x7F, iScratchModRM, 0x24 });           // movdqu [rsp], xmmS
+            code.insert(code.end(), { 0xF3, 0x44, 0x0F, 0x10, (uint8_t)(((iScratch & 7) << 3) | 0x05), 0, 0, 0, 0 }); // movss xmmS, [rip+value]
+            fixups.push_back({ code.size() - 4, 2 });
+            code.insert(code.end(), { 0xF3, (uint8_t)(0x41 | (iRegister >= 8 ? 0x04 : 0x00)), 0x0F, 0x10,
+                (uint8_t)(0xC0 | ((iRegister & 7) << 3) | (iScratch & 7)) });                    // movss xmmN, xmmS
+            code.insert(code.end(), { 0xF3, 0x44, 0x0F, 0x6F, iScratchModRM, 0x24 });           // movdqu xmmS, [rsp]
+            code.insert(code.end(), { 0x48, 0x8D, 0x64, 0x24, 0x10 });                          // lea rsp, [rsp+0x10]
+        }
+
+        // pause, looped on through the trampoline slot until it is filled
+        size_t waitOffset = code.size();
+        code.insert(code.end(), { 0xF3, 0x90 });
+
+        // jmp [rip+trampoline]
+        hook.m_resumeOffset = code.size();
+        code.insert(code.end(), { 0xFF, 0x25, 0, 0, 0, 0 });
+        fixups.push_back({ code.size() - 4, 1 });
+
+        // Slots
+        while (code.size() % 8)
+            code.push_back(0xCC);
+        hook.m_entryOffset = code.size();
+        size_t trampolineOffset = hook.m_entryOffset + 8;
+        hook.m_valueOffset = trampolineOffset + 8;
+        code.resize(hook.m_valueOffset + 4, 0);
+
+        const size_t slotOffsets[] = { hook.m_entryOffset, trampolineOffset, hook.m_valueOffset };
+        for (auto& [pos, slot] : fixups)
+            EmitRipRelative(code, pos, slotOffsets[slot]);
+
+        // Stubs are packed back to back, so pad the allocation to keep the slots naturally aligned.
+        HookArena::Prepare();
+        auto stub = HookArena::Allocate(code.size() + 7);
+        if (!stub)
+            return hook;
+
+        hook.m_stub = std::move(*stub);
+        size_t iAlign = (8 - (hook.m_stub.address() & 7)) & 7;
+        hook.m_applyOffset += iAlign;
+        hook.m_resumeOffset += iAlign;
+        hook.m_entryOffset += iAlign;
+        hook.m_valueOffset += iAlign;
+        trampolineOffset += iAlign;
+        waitOffset += iAlign;
+        memset(hook.m_stub.data(), 0xCC, hook.m_stub.size());
+        memcpy(hook.m_stub.data() + iAlign, code.data(), code.size());
+        uint8_t* stubCode = hook.m_stub.data() + iAlign;
+        memcpy(hook.m_stub.data() + hook.m_valueOffset, &iValue, sizeof(iValue));
+        uintptr_t entry = hook.m_stub.address() + hook.m_applyOffset;
+        memcpy(hook.m_stub.data() + hook.m_entryOffset, &entry, sizeof(entry));
+        uintptr_t wait = hook.m_stub.address() + waitOffset;
+        memcpy(hook.m_stub.data() + trampolineOffset, &wait, sizeof(wait));
+
+        auto inlineHook = SafetyHookInline::create(HookArena::allocator, target, stubCode);
+        if (!inlineHook) {
+            hook.m_stub.free();
+            return hook;
+        }
+
+        hook.m_hook = std::move(*inlineHook);
+        uintptr_t trampoline = hook.m_hook.trampoline().address();
+        HookArena::Track(trampoline, hook.m_hook.trampoline().size());
+        reinterpret_cast<std::atomic<uintptr_t>*>(hook.m_stub.data() + trampolineOffset)->store(trampoline, std::memory_order_release);
+        SymbolMap::AddHook({ "", "light", hook.m_hook.target_address(), hook.m_hook.original_bytes().size(), hook.m_stub.address(), hook.m_stub.size(),
+            trampoline, hook.m_hook.trampoline().size() });
+        return hook;
+    }
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Shared-memory metrics export.
+// A fixed-layout block in a named mapping is rewritten every frame under a seqlock: the writer makes the sequence odd,
+// copies the payload and makes it even again, readers copy the payload and retry if the sequence moved. The game
+// never waits on a reader. Fields are only ever appended, bumping iVersion, so older readers keep working.
+// No Windows headers beyond the mapping calls, so tools/metricsreader can build and test it on Linux.
+namespace Metrics
+{
+    inline constexpr uint32_t iMagic = 0x58464B42;     // "BKFX"
+    inline constexpr uint16_t iVersion = 1;
+
+#ifdef _WIN32
+    inline constexpr const wchar_t* sMappingName = L"Local\\BerserkFix_Metrics";
+#else
+    inline constexpr const char* sMappingName = "/BerserkFix_Metrics";
+#endif
+
+    struct Header {
+        uint32_t iMagic;
+        uint16_t iVersion;
+        uint16_t iHeaderSize;
+        uint32_t iBlockSize;
+        uint32_t iProcessId;
+        int64_t iFrequency;             // Timestamp ticks per second
+    };
+
+    struct Payload {
+        uint64_t iFrame;
+        int64_t iTimestamp;             // Ticks, see Header::iFrequency
+        float fFrameTime;               // Milliseconds between the last two frame boundaries
+        float fGameFrametime;           // Seconds, the game's own measurement (only updated with a custom framerate cap)
+        float fFramerateCap;
+        float fGameSpeedStep;
+        int32_t iResX;
+        int32_t iResY;
+        float fAspectRatio;
+        int32_t iShadowResolution;
+        uint32_t iHookArenaBytes;
+        uint32_t iGatedHooks;
+        uint64_t iHeapAllocations;
+        uint64_t iHeapFrees;
+        uint64_t iHeapCommittedBytes;
+        uint64_t iFileCacheBytes;
+    };
+
+    struct Block {
+        Header header;
+        alignas(64) std::atomic<uint32_t> iSequence;
+        alignas(8) Payload payload;
+    };
+
+    static_assert(sizeof(Header) == 24);
+    static_assert(offsetof(Block, iSequence) == 64);
+    static_assert(offsetof(Block, payload) == 72);
+    static_assert(sizeof(Payload) == 88);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    // Slow-changing values, refreshed off the game thread and copied in by the frame writer
+    struct Counters {
+        std::atomic<uint32_t> iHookArenaBytes = 0;
+        std::atomic<uint32_t> iGatedHooks = 0;
+        std::atomic<uint64_t> iHeapAllocations = 0;
+        std::atomic<uint64_t> iHeapFrees = 0;
+        std::atomic<uint64_t> iHeapCommittedBytes = 0;
+        std::atomic<uint64_t> iFileCacheBytes = 0;
+    };
+
+    inline Counters counters{};
+    inline std::atomic<Block*> block = nullptr;
+
+#ifdef _WIN32
+    inline HANDLE hMapping = NULL;
+#endif
+
+    // Writer side, creates the mapping
+    inline Block* Create(uint32_t iProcessId, int64_t iFrequency)
+    {
+#ifdef _WIN32
+        hMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(Block), sMappingName);
+        if (!hMapping)
+            return nullptr;
+        void* view = MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Block));
+        if (!view) {
+            CloseHandle(hMapping);
+            hMapping = NULL;
+            return nullptr;
+        }
+#else
+        int fd = shm_open(sMappingName, O_CREAT | O_RDWR, 0644);
+        if (fd < 0)
+            return nullptr;
+        if (ftruncate(fd, sizeof(Block)) != 0) {
+            close(fd);
+            return nullptr;
+        }
+        void* view = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+            return nullptr;
+#endif
+        Block* created = static_cast<Block*>(view);
+        created->iSequence.store(0, std::memory_order_relaxed);
+        memset(&created->payload, 0, sizeof(Payload));
+        created->header.iVersion = iVersion;
+        created->header.iHeaderSize = sizeof(Header);
+        created->header.iBlockSize = sizeof(Block);
+        created->header.iProcessId = iProcessId;
+        created->header.iFrequency = iFrequency;
+        // Magic last, readers treat the block as valid once it's there
+        std::atomic_thread_fence(std::memory_order_release);
+        created->header.iMagic = iMagic;
+
+        // Publish() starts writing from here on
+        block.store(created, std::memory_order_release);
+        return created;
+    }
+
+    // Single writer only
+    inline void Publish(const Payload& payload)
+    {
+        Block* target = block.load(std::memory_order_acquire);
+        if (!target)
+            return;
+
+        uint32_t iSequence = target->iSequence.load(std::memory_order_relaxed);
+        target->iSequence.store(iSequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&target->payload, &payload, sizeof(Payload));
+        target->iSequence.store(iSequence + 2, std::memory_order_release);
+    }
+
+    // Reader side
+    inline void Close(const Block* opened)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(opened);
+#else
+        munmap(const_cast<Block*>(opened), sizeof(Block));
+#endif
+    }
+
+    inline const Block* Open()
+    {
+#ifdef _WIN32
+        HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, sMappingName);
+        if (!mapping)
+            return nullptr;
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view)
+            return nullptr;
+#else
+        int fd = shm_open(sMappingName, O_RDONLY, 0);
+        if (fd < 0)
+            return nullptr;
+        const void* view = mmap(nullptr, sizeof(Block), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED)
+            return nullptr;
+#endif
+        const Block* opened = static_cast<const Block*>(view);
+        if (opened->header.iMagic != iMagic || opened->header.iBlockSize < offsetof(Block, payload)) {
+            Close(opened);
+            return nullptr;
+        }
+        return opened;
+    }
+
+    // Consistent snapshot of the payload, false if the writer kept it busy for every attempt.
+    // Fields newer than the writer's block size are left zeroed.
+    inline bool Read(const Block* source, Payload& payload, int iAttempts = 1000)
+    {
+        size_t iSize = source->header.iBlockSize - offsetof(Block, payload);
+        if (iSize > sizeof(Payload))
+            iSize = sizeof(Payload);
+
+        for (int i = 0; i < iAttempts; i++) {
+            uint32_t iBefore = source->iSequence.load(std::memory_order_acquire);
+            if (iBefore & 1)
+                continue;
+
+            memset(&payload, 0, sizeof(Payload));
+            memcpy(&payload, &source->payload, iSize);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (source->iSequence.load(std::memory_order_relaxed) == iBefore)
+                return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Pre-patch manifest.
+// tools/patchbake writes the fix's static byte patches straight into a copy of the executable and records each one
+// here as name, feature, RVA, original bytes and patched bytes, for one build of the game identified by the PE
+// timestamp and image size (both unchanged by baking). At startup the fix skips the scan and write for every patch
+// that is already present in the loaded image with the bytes the current settings ask for.
+namespace PrePatch
+{
+    struct Patch {
+        std::string sName;
+        std::string sFeature;       // Function in dllmain.cpp that would otherwise apply it
+        uint32_t iRva = 0;
+        std::vector<uint8_t> original{};
+        std::vector<uint8_t> patched{};
+    };
+
+    struct Manifest {
+        uint32_t iTimestamp = 0;
+        uint32_t iImageSize = 0;
+        std::vector<Patch> patches{};
+
+        const Patch* Find(const std::string& sName) const
+        {
+            for (const Patch& patch : patches) {
+                if (patch.sName == sName)
+                    return &patch;
+            }
+            return nullptr;
+        }
+    };
+
+    // Bytes the fix writes for each static patch
+    inline constexpr uint8_t JumpShort[] = { 0xEB };        // jz/jp rel8 -> jmp rel8
+    inline constexpr uint32_t iResolutionEntryOffset = 0x6; // 800x450 entry in the resolution list
+    inline constexpr int iForcedResolutionIndex = 1;
+
+    template<typename T>
+    std::vector<uint8_t> Bytes(const T& value)
+    {
+        std::vector<uint8_t> bytes(sizeof(T));
+        memcpy(bytes.data(), &value, sizeof(T));
+        return bytes;
+    }
+
+    inline std::vector<uint8_t> ResolutionEntry(int iResX, int iResY)
+    {
+        const short entry[3] = { (short)iResX, (short)iResY, (short)iResY };
+        return Bytes(entry);
+    }
+
+    inline std::string ToHex(const std::vector<uint8_t>& bytes)
+    {
+        static constexpr char sDigits[] = "0123456789ABCDEF";
+        std::string sHex;
+        for (uint8_t iByte : bytes) {
+            sHex += sDigits[iByte >> 4];
+            sHex += sDigits[iByte & 0xF];
+        }
+        return sHex;
+    }
+
+    inline bool FromHex(const std::string& sHex, std::vector<uint8_t>& bytes)
+    {
+        bytes.clear();
+        if (sHex.empty() || sHex.size() % 2)
+            return false;
+        for (size_t i = 0; i < sHex.size(); i += 2) {
+            char* sEnd = nullptr;
+            std::string sByte = sHex.substr(i, 2);
+            bytes.push_back(static_cast<uint8_t>(strtoul(sByte.c_str(), &sEnd, 16)));
+            if (*sEnd)
+                return false;
+        }
+        return true;
+    }
+
+    // Name = Feature RVA original patched
+    inline bool Read(std::istream& stream, Manifest& manifest)
+    {
+        manifest = {};
+        std::string sLine;
+        while (std::getline(stream, sLine)) {
+            if (sLine.empty() || sLine[0] == ';')
+                continue;
+
+            size_t iSeparator = sLine.find('=');
+            if (iSeparator == std::string::npos)
+                return false;
+
+            std::string sKey = sLine.substr(0, sLine.find_last_not_of(' ', iSeparator - 1) + 1);
+            std::istringstream value(sLine.substr(iSeparator + 1));
+            if (sKey == "Timestamp") {
+                value >> std::hex >> manifest.iTimestamp;
+                continue;
+            }
+            if (sKey == "ImageSize") {
+                value >> std::hex >> manifest.iImageSize;
+                continue;
+            }
+
+            Patch patch{};
+            patch.sName = sKey;
+            std::string sOriginal, sPatched;
+            if (!(value >> patch.sFeature >> std::hex >> patch.iRva >> sOriginal >> sPatched))
+                return false;
+            if (!FromHex(sOriginal, patch.original) || !FromHex(sPatched, patch.patched) || patch.original.size() != patch.patched.size())
+                return false;
+            manifest.patches.push_back(std::move(patch));
+        }
+        return manifest.iTimestamp != 0 && manifest.iImageSize != 0;
+    }
+
+    inline void Write(std::ostream& stream, const Manifest& manifest)
+    {
+        stream << "; BerserkFix pre-patch manifest, written by tools/patchbake for the executable it patched\n";
+        stream << "; Name = Feature RVA original patched\n";
+        stream << std::hex << "Timestamp = 0x" << manifest.iTimestamp << "\n";
+        stream << "ImageSize = 0x" << manifest.iImageSize << "\n";
+        for (const Patch& patch : manifest.patches)
+            stream << patch.sName << " = " << patch.sFeature << " 0x" << patch.iRva << " " << ToHex(patch.original) << " " << ToHex(patch.patched) << "\n";
+        stream << std::dec;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// Scan result cache.
+// Signature name -> match RVA for one build of the game, identified by the PE timestamp and image size.
+// Plain text so a cache generated offline by tools/sigcheck can be shipped next to the fix.
+namespace ScanCache
+{
+    struct Cache {
+        uint32_t iTimestamp = 0;
+        uint32_t iImageSize = 0;
+        std::map<std::string, uint32_t> results{};
+    };
+
+    inline bool Read(std::istream& stream, Cache& cache)
+    {
+        cache = {};
+        std::string sLine;
+        while (std::getline(stream, sLine)) {
+            if (sLine.empty() || sLine[0] == ';')
+                continue;
+
+            size_t iSeparator = sLine.find('=');
+            if (iSeparator == std::string::npos)
+                return false;
+
+            std::string sKey = sLine.substr(0, sLine.find_last_not_of(' ', iSeparator - 1) + 1);
+            uint32_t iValue = 0;
+            std::istringstream(sLine.substr(iSeparator + 1)) >> std::hex >> iValue;
+
+            if (sKey == "Timestamp")
+                cache.iTimestamp = iValue;
+            else if (sKey == "ImageSize")
+                cache.iImageSize = iValue;
+            else
+                cache.results[sKey] = iValue;
+        }
+        return cache.iTimestamp != 0 && cache.iImageSize != 0;
+    }
+
+    inline void Write(std::ostream& stream, const Cache& cache)
+    {
+        stream << "; BerserkFix scan cache, regenerated automatically when the game is updated\n";
+        stream << std::hex << "Timestamp = 0x" << cache.iTimestamp << "\n";
+        stream << "ImageSize = 0x" << cache.iImageSize << "\n";
+        for (const auto& [sName, iRva] : cache.results)
+            stream << sName << " = 0x" << iRva << "\n";
+        stream << std::dec;
+    }
+}
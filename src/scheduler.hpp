@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#endif
+
+// Thread placement for hybrid (P-core/E-core) CPUs.
+// Classification, affinity selection and applied-thread tracking are pure functions over a thread list and a
+// topology, the Windows-specific enumeration and policy application sit on top of them. Only those need Windows
+// headers, so tools/schedcheck can build and test the rest on Linux.
+namespace Scheduler
+{
+    enum class ThreadClass { Main, Render, Worker, Other };
+
+    enum class Affinity { All, PCores, ECores };
+
+    struct ThreadInfo {
+        uint32_t iThreadId;
+        uintptr_t iStartAddress;
+        uint64_t iCreationTime;
+    };
+
+    struct Topology {
+        uint64_t iPerformanceMask;  // Logical processors on the fastest core class
+        uint64_t iEfficiencyMask;   // Logical processors on slower core classes (0 on non-hybrid CPUs)
+    };
+
+    struct Policy {
+        Affinity affinity = Affinity::All;
+        int iPriority = 0;          // THREAD_PRIORITY_NORMAL
+        bool bDisablePowerThrottling = false;
+    };
+
+    // Windows reuses the IDs of exited threads, so a thread is only the same thread if its creation time matches too
+    using ThreadKey = std::pair<uint32_t, uint64_t>;
+
+    inline const char* ThreadClassName(ThreadClass threadClass)
+    {
+        switch (threadClass) {
+        case ThreadClass::Main: return "Main";
+        case ThreadClass::Render: return "Render";
+        case ThreadClass::Worker: return "Worker";
+        default: return "Other";
+        }
+    }
+
+    inline Affinity ParseAffinity(const std::string& sAffinity)
+    {
+        if (sAffinity == "PCores")
+            return Affinity::PCores;
+        if (sAffinity == "ECores")
+            return Affinity::ECores;
+        return Affinity::All;
+    }
+
+    // The main thread is the oldest thread that starts inside the game image.
+    // A render thread can be pinned down by start RVA (0 = none), everything else inside the image is a worker.
+    inline std::vector<ThreadClass> Classify(const std::vector<ThreadInfo>& threads, uintptr_t iModuleBase, size_t iModuleSize, uintptr_t iRenderThreadRVA)
+    {
+        std::vector<ThreadClass> classes(threads.size(), ThreadClass::Other);
+
+        size_t iMainIndex = SIZE_MAX;
+        for (size_t i = 0; i < threads.size(); i++) {
+            uintptr_t iStart = threads[i].iStartAddress;
+            if (iStart < iModuleBase || iStart >= iModuleBase + iModuleSize)
+                continue;
+
+            if (iRenderThreadRVA && iStart == iModuleBase + iRenderThreadRVA) {
+                classes[i] = ThreadClass::Render;
+                continue;
+            }
+
+            classes[i] = ThreadClass::Worker;
+            if (iMainIndex == SIZE_MAX || threads[i].iCreationTime < threads[iMainIndex].iCreationTime)
+                iMainIndex = i;
+        }
+
+        if (iMainIndex != SIZE_MAX)
+            classes[iMainIndex] = ThreadClass::Main;
+
+        return classes;
+    }
+
+    // Returns 0 when the policy doesn't restrict affinity or the requested core class doesn't exist.
+    inline uint64_t AffinityMask(Affinity affinity, const Topology& topology, uint64_t iProcessMask)
+    {
+        uint64_t iMask = 0;
+        if (affinity == Affinity::PCores)
+            iMask = topology.iPerformanceMask;
+        else if (affinity == Affinity::ECores)
+            iMask = topology.iEfficiencyMask;
+        return iMask & iProcessMask;
+    }
+
+    // Returns the indices of threads that still need a policy and records them in applied. Keys of threads missing
+    // from the snapshot are dropped, so applied never grows past the live thread list and a new thread that reuses
+    // an old ID is picked up again.
+    inline std::vector<size_t> Untracked(const std::vector<ThreadInfo>& threads, const std::vector<ThreadClass>& classes, std::set<ThreadKey>& applied)
+    {
+        std::set<ThreadKey> live{};
+        std::vector<size_t> untracked{};
+        for (size_t i = 0; i < threads.size(); i++) {
+            ThreadKey key{ threads[i].iThreadId, threads[i].iCreationTime };
+            live.insert(key);
+            if (classes[i] != ThreadClass::Other && !applied.contains(key))
+                untracked.push_back(i);
+        }
+
+        std::erase_if(applied, [&](const ThreadKey& key) { return !live.contains(key); });
+        for (size_t i : untracked)
+            applied.insert({ threads[i].iThreadId, threads[i].iCreationTime });
+        return untracked;
+    }
+
+#ifdef _WIN32
+    // Cores are grouped by EfficiencyClass, the highest class is the performance class.
+    // Only processor group 0 is considered, which covers every consumer CPU.
+    inline Topology QueryTopology()
+    {
+        Topology topology{};
+        DWORD iLength = 0;
+        GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &iLength);
+        if (iLength == 0)
+            return topology;
+
+        std::vector<uint8_t> buffer(iLength);
+        if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &iLength))
+            return topology;
+
+        std::vector<std::pair<BYTE, uint64_t>> cores{};
+        BYTE iMaxClass = 0;
+        for (DWORD iOffset = 0; iOffset < iLength;) {
+            auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + iOffset);
+            if (info->Relationship == RelationProcessorCore && info->Processor.GroupMask[0].Group == 0) {
+                cores.push_back({ info->Processor.EfficiencyClass, (uint64_t)info->Processor.GroupMask[0].Mask });
+                iMaxClass = std::max(iMaxClass, info->Processor.EfficiencyClass);
+            }
+            iOffset += info->Size;
+        }
+
+        for (auto& [iClass, iMask] : cores) {
+            if (iClass == iMaxClass)
+                topology.iPerformanceMask |= iMask;
+            else
+                topology.iEfficiencyMask |= iMask;
+        }
+        return topology;
+    }
+
+    inline std::vector<ThreadInfo> EnumerateThreads()
+    {
+        std::vector<ThreadInfo> threads{};
+
+        using NtQueryInformationThread_t = LONG(NTAPI*)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+        static auto NtQueryInformationThread_fn = reinterpret_cast<NtQueryInformationThread_t>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQueryInformationThread"));
+        if (!NtQueryInformationThread_fn)
+            return threads;
+
+        HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+        if (hSnapshot == INVALID_HANDLE_VALUE)
+            return threads;
+
+        DWORD iProcessId = GetCurrentProcessId();
+        THREADENTRY32 entry{ .dwSize = sizeof(THREADENTRY32) };
+        for (BOOL bOk = Thread32First(hSnapshot, &entry); bOk; bOk = Thread32Next(hSnapshot, &entry)) {
+            if (entry.th32OwnerProcessID != iProcessId)
+                continue;
+
+            HANDLE hThread = OpenThread(THREAD_QUERY_INFORMATION, FALSE, entry.th32ThreadID);
+            if (!hThread)
+                continue;
+
+            ThreadInfo thread{ .iThreadId = entry.th32ThreadID };
+            FILETIME creation{}, exit{}, kernel{}, user{};
+            if (GetThreadTimes(hThread, &creation, &exit, &kernel, &user))
+                thread.iCreationTime = ((uint64_t)creation.dwHighDateTime << 32) | creation.dwLowDateTime;
+
+            // ThreadQuerySetWin32StartAddress
+            NtQueryInformationThread_fn(hThread, 9, &thread.iStartAddress, sizeof(thread.iStartAddress), nullptr);
+            CloseHandle(hThread);
+            threads.push_back(thread);
+        }
+
+        CloseHandle(hSnapshot);
+        return threads;
+    }
+
+    inline bool ApplyPolicy(DWORD iThreadId, const Policy& policy, const Topology& topology, uint64_t iProcessMask)
+    {
+        HANDLE hThread = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, iThreadId);
+        if (!hThread)
+            return false;
+
+        if (uint64_t iMask = AffinityMask(policy.affinity, topology, iProcessMask))
+            SetThreadAffinityMask(hThread, (DWORD_PTR)iMask);
+
+        SetThreadPriority(hThread, policy.iPriority);
+
+        if (policy.bDisablePowerThrottling) {
+            // Opt the thread out of EcoQoS so Windows doesn't park it on efficiency cores
+            THREAD_POWER_THROTTLING_STATE state{ .Version = THREAD_POWER_THROTTLING_CURRENT_VERSION, .ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED, .StateMask = 0 };
+            SetThreadInformation(hThread, ThreadPowerThrottling, &state, sizeof(state));
+        }
+
+        CloseHandle(hThread);
+        return true;
+    }
+#endif
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Every signature the fix scans for.
+// Kept free of Windows headers so the offline tools in tools/ resolve exactly what the fix does at runtime.
+namespace Signatures
+{
+    struct Signature {
+        const char* sName;
+        const char* sFeature;       // Function in dllmain.cpp that scans for it
+        const char* sPattern;
+        bool bAbsolute = false;     // Match + iAbsoluteOffset is a rel32 resolved with Memory::GetAbsolute()
+        int iAbsoluteOffset = 0;
+    };
+
+    // Resolution()
+    inline constexpr Signature ResolutionList{ "ResolutionList", "Resolution", "4C ?? ?? ?? ?? ?? ?? 41 ?? ?? 41 ?? ?? 45 ?? ?? ?? ?? C7 ?? ?? ?? ?? ?? ??", true, 0x3 };
+    inline constexpr Signature ResolutionIndex{ "ResolutionIndex", "Resolution", "83 ?? 0F 0F ?? ?? 89 ?? ?? ?? ?? ?? C3", true, -0x4 };
+    inline constexpr Signature SystemMetrics1{ "SystemMetrics1", "Resolution", "B9 01 00 00 00 41 ?? ?? 99 2B ?? D1 ?? 8B ??" };
+    inline constexpr Signature SystemMetrics2{ "SystemMetrics2", "Resolution", "0F ?? ?? 3B ?? 7C ?? B9 01 00 00 00 FF ?? ?? ?? ?? ?? 0F ?? ?? ?? 3B ?? 7D ?? 33 ??" };
+    inline constexpr Signature ResCheck{ "ResCheck", "Resolution", "74 ?? 33 ?? FF ?? ?? ?? ?? ?? 0F ?? ?? ?? 3B ?? 7C ??" };
+    inline constexpr Signature WindowMode{ "WindowMode", "Resolution", "8B ?? ?? ?? ?? ?? 48 ?? ?? 83 ?? 02 0F 83 ?? ?? ?? ?? 83 ?? 01", true, 0x2 };
+
+    // AspectFOV()
+    inline constexpr Signature AspectRatio{ "AspectRatio", "AspectFOV", "8B ?? ?? ?? ?? ?? C6 ?? ?? ?? ?? ?? 01 89 ?? ?? ?? ?? ?? 40 ?? ?? ?? ?? ?? ?? 75 ??" };
+    inline constexpr Signature MenuAspectRatio{ "MenuAspectRatio", "AspectFOV", "F3 0F ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??" };
+    inline constexpr Signature GlobalFOV{ "GlobalFOV", "AspectFOV", "0F ?? ?? ?? ?? D1 ?? 44 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? A8 01" };
+    inline constexpr Signature GameplayFOV{ "GameplayFOV", "AspectFOV", "F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? F3 0F ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ??" };
+    inline constexpr Signature GameplayLockOnFOV{ "GameplayLockOnFOV", "AspectFOV", "0F ?? ?? E8 ?? ?? ?? ?? F3 44 ?? ?? ?? ?? ?? 41 0F ?? ?? 0F ?? ?? 0F ?? ??" };
+
+    // HUD()
+    inline constexpr Signature HUDSize{ "HUDSize", "HUD", "F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 8B ?? ?? ?? 89 ?? ??" };
+    inline constexpr Signature HUDOffsetCodepath{ "HUDOffsetCodepath", "HUD", "7A ?? 75 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 7A ?? 74 ?? 48 ?? ?? ?? ?? ?? ?? 00 74 ??" };
+    inline constexpr Signature HUDOffset{ "HUDOffset", "HUD", "F3 0F ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 0F ?? ?? ?? 42 ?? ?? ?? ??" };
+    inline constexpr Signature EnemyNames{ "EnemyNames", "HUD", "B8 ?? ?? ?? ?? 6B ?? ?? F7 ?? 03 ?? C1 ?? ?? 8B ?? C1 ?? ?? 03 ?? 49 ?? ?? ??" };
+    inline constexpr Signature Movies{ "Movies", "HUD", "F3 0F ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 48 ?? ?? ?? 00 00 00 00 0F ?? ??" };
+    inline constexpr Signature Fades{ "Fades", "HUD", "66 0F ?? ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ?? 0F ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ??" };
+    inline constexpr Signature PauseCapture{ "PauseCapture", "HUD", "C7 ?? ?? ?? 00 00 87 44 F3 0F ?? ?? ?? ?? 44 ?? ?? ?? ?? ?? ?? ?? 4C ?? ?? ?? ??" };
+    inline constexpr Signature PauseBG{ "PauseBG", "HUD", "D2 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? F3 0F ?? ?? ??" };
+    inline constexpr Signature MissionSelectCapture{ "MissionSelectCapture", "HUD", "E8 ?? ?? ?? ?? 48 8B ?? ?? ?? ?? ?? ?? 45 ?? ?? BA 01 00 00 00 E8 ?? ?? ?? ??" };
+    inline constexpr Signature MissionSelectBG{ "MissionSelectBG", "HUD", "48 ?? ?? ?? 49 ?? ?? ?? 4C ?? ?? ?? 4C ?? ?? ?? E8 ?? ?? ?? ?? 48 ?? ?? ?? ?? 48 ?? ?? ?? 5F C3" };
+    inline constexpr Signature MenuBackgrounds{ "MenuBackgrounds", "HUD", "7E ?? 49 ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 4C ?? ?? ?? ?? 4C ?? ?? ?? ??" };
+    inline constexpr Signature HUDBackgrounds1{ "HUDBackgrounds1", "HUD", "8B ?? 89 ?? ?? 48 8B ?? ?? 48 89 ?? ?? 48 89 ?? ?? 48 89 ?? ??" };
+    inline constexpr Signature HUDBackgrounds2{ "HUDBackgrounds2", "HUD", "45 ?? ?? 0F 84 ?? ?? ?? ?? 48 ?? ?? E8 ?? ?? ?? ?? 33 ?? 83 ?? ?? ?? ?? ?? 03" };
+    inline constexpr Signature HUDBackgrounds3{ "HUDBackgrounds3", "HUD", "48 8B ?? ?? 48 89 ?? ?? 48 89 ?? ?? 48 89 ?? ?? 83 ?? ?? ?? ?? ?? 00 74 ??" };
+    inline constexpr Signature HUDBackgrounds4{ "HUDBackgrounds4", "HUD", "48 ?? ?? ?? 89 ?? ?? 44 0F ?? ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ?? 48 ?? ?? ??" };
+    inline constexpr Signature HUDBackgrounds5{ "HUDBackgrounds5", "HUD", "F3 0F ?? ?? ?? ?? 85 ?? 74 ?? FF ?? 74 ?? FF ?? 75 ??" };
+    inline constexpr Signature HUDBackgrounds6{ "HUDBackgrounds6", "HUD", "F3 41 ?? ?? ?? ?? F3 45 ?? ?? ?? ?? 85 ?? 74 ?? 83 ?? 0F" };
+
+    // Framerate()
+    inline constexpr Signature FramerateCap{ "FramerateCap", "Framerate", "F3 0F ?? ?? 0F ?? ?? 0F ?? ?? 76 ?? F3 0F ?? ?? ?? ?? ?? ?? F3 ?? ?? ?? ?? 83 ?? 01" };
+    inline constexpr Signature GameSpeed{ "GameSpeed", "Framerate", "0F ?? ?? F3 0F ?? ?? F3 0F ?? ?? 0F ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? 0F ?? ?? 72 ??" };
+    inline constexpr Signature CurrentFrametime{ "CurrentFrametime", "Framerate", "66 0F ?? ?? ?? ?? ?? ?? 66 0F ?? ?? 0F ?? ?? 72 ?? F3 0F ?? ?? ??" };
+    inline constexpr Signature ControllerInputSpeed{ "ControllerInputSpeed", "Framerate", "41 0F ?? ?? 41 ?? ?? 41 ?? ?? 3C ?? 72 ?? 8B ?? 09 ?? ??" };
+    inline constexpr Signature KeyboardInputSpeed{ "KeyboardInputSpeed", "Framerate", "F3 ?? ?? ?? ?? E8 ?? ?? ?? ?? 41 ?? ?? 48 ?? ?? ?? ?? ?? ?? 8B ?? 85 ?? 74 ?? FF ??" };
+
+    // Misc()
+    inline constexpr Signature WindowsCompatibilityMessage{ "WindowsCompatibilityMessage", "Misc", "85 ?? 0F 84 ?? ?? ?? ?? 83 3D ?? ?? ?? ?? 00 75 ?? 48 ?? ?? ?? ?? ?? ?? 33 ??" };
+    inline constexpr Signature ShadowQuality{ "ShadowQuality", "Misc", "C6 ?? ?? ?? ?? 33 ?? 41 ?? 01 00 00 00 89 ?? ?? ??" };
+
+    inline constexpr const Signature* All[] = {
+        &ResolutionList, &ResolutionIndex, &SystemMetrics1, &SystemMetrics2,
+        &ResCheck, &WindowMode, &AspectRatio, &MenuAspectRatio,
+        &GlobalFOV, &GameplayFOV, &GameplayLockOnFOV, &HUDSize,
+        &HUDOffsetCodepath, &HUDOffset, &EnemyNames, &Movies,
+        &Fades, &PauseCapture, &PauseBG, &MissionSelectCapture,
+        &MissionSelectBG, &MenuBackgrounds, &HUDBackgrounds1, &HUDBackgrounds2,
+        &HUDBackgrounds3, &HUDBackgrounds4, &HUDBackgrounds5, &HUDBackgrounds6,
+        &FramerateCap, &GameSpeed, &CurrentFrametime, &ControllerInputSpeed,
+        &KeyboardInputSpeed, &WindowsCompatibilityMessage, &ShadowQuality
+    };
+
+    // Same rules as Memory::PatternScan(), -1 is a wildcard byte
+    inline std::vector<int> ParsePattern(const char* sPattern)
+    {
+        std::vector<int> bytes{};
+        const char* current = sPattern;
+        const char* end = sPattern + strlen(sPattern);
+        while (current < end) {
+            if (*current == ' ') {
+                ++current;
+            }
+            else if (*current == '?') {
+                ++current;
+                if (*current == '?')
+                    ++current;
+                bytes.push_back(-1);
+            }
+            else {
+                char* next = nullptr;
+                bytes.push_back(static_cast<int>(strtoul(current, &next, 16)));
+                current = next;
+            }
+        }
+        return bytes;
+    }
+
+    inline bool Matches(const uint8_t* data, size_t iSize, const std::vector<int>& pattern)
+    {
+        if (pattern.empty() || iSize < pattern.size())
+            return false;
+
+        for (size_t i = 0; i < pattern.size(); i++) {
+            if (pattern[i] != -1 && data[i] != pattern[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Target of the rel32 at match + iAbsoluteOffset, as an offset from match
+    inline int64_t AbsoluteOffset(const uint8_t* match, const Signature& signature)
+    {
+        int32_t iDisplacement = 0;
+        memcpy(&iDisplacement, match + signature.iAbsoluteOffset, sizeof(iDisplacement));
+        return (int64_t)signature.iAbsoluteOffset + 4 + iDisplacement;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <dxgi1_5.h>
+#else
+// The few DXGI types and constants the translation needs, with the SDK's values, so tools/swapchaincheck builds on Linux
+using UINT = uint32_t;
+using BOOL = int;
+
+enum DXGI_FORMAT : UINT {
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+    DXGI_FORMAT_R10G10B10A2_UNORM = 24,
+    DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+    DXGI_FORMAT_B8G8R8A8_UNORM = 87,
+    DXGI_FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+};
+
+enum DXGI_SWAP_EFFECT : UINT {
+    DXGI_SWAP_EFFECT_DISCARD = 0,
+    DXGI_SWAP_EFFECT_SEQUENTIAL = 1,
+    DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL = 3,
+    DXGI_SWAP_EFFECT_FLIP_DISCARD = 4,
+};
+
+struct DXGI_MODE_DESC {
+    UINT Width;
+    UINT Height;
+    DXGI_FORMAT Format;
+};
+
+struct DXGI_SAMPLE_DESC {
+    UINT Count;
+    UINT Quality;
+};
+
+struct DXGI_SWAP_CHAIN_DESC {
+    DXGI_MODE_DESC BufferDesc;
+    DXGI_SAMPLE_DESC SampleDesc;
+    UINT BufferCount;
+    BOOL Windowed;
+    DXGI_SWAP_EFFECT SwapEffect;
+    UINT Flags;
+};
+
+inline constexpr UINT DXGI_MAX_SWAP_CHAIN_BUFFERS = 16;
+inline constexpr UINT DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING = 2048;
+inline constexpr UINT DXGI_PRESENT_TEST = 0x1;
+inline constexpr UINT DXGI_PRESENT_ALLOW_TEARING = 0x200;
+#endif
+
+// Flip-model swapchain translation.
+// Kept free of any hooking so the descriptor rules can be checked on their own, see tools/swapchaincheck.
+namespace Swapchain
+{
+    // Flip model only accepts these back buffer formats (no sRGB, no MSAA).
+    inline bool IsFlipCompatibleFormat(DXGI_FORMAT format)
+    {
+        switch (format) {
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Rewrites a legacy blit-model descriptor to FLIP_DISCARD. Returns false and leaves the descriptor untouched if
+    // the game's settings can't be expressed with flip model.
+    inline bool UpgradeDesc(DXGI_SWAP_CHAIN_DESC& desc, UINT iBufferCount, bool bAllowTearing)
+    {
+        if (!desc.Windowed)
+            return false;
+
+        if (desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_DISCARD || desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL)
+            return false;
+
+        if (desc.SampleDesc.Count != 1 || !IsFlipCompatibleFormat(desc.BufferDesc.Format))
+            return false;
+
+        desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        desc.BufferCount = std::clamp(std::max(desc.BufferCount, iBufferCount), 2u, (UINT)DXGI_MAX_SWAP_CHAIN_BUFFERS);
+        if (bAllowTearing)
+            desc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+        return true;
+    }
+
+    // ResizeBuffers must keep the creation flags and a flip-model legal buffer count. 0 keeps the current count.
+    inline void TranslateResizeBuffers(UINT& iBufferCount, UINT& iFlags, UINT iUpgradedBufferCount, bool bAllowTearing)
+    {
+        if (iBufferCount != 0)
+            iBufferCount = std::clamp(std::max(iBufferCount, iUpgradedBufferCount), 2u, (UINT)DXGI_MAX_SWAP_CHAIN_BUFFERS);
+
+        if (bAllowTearing)
+            iFlags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+
+    // Tearing is only legal with sync interval 0 and is how VRR/uncapped presents work in a window.
+    inline UINT TranslatePresentFlags(UINT iSyncInterval, UINT iFlags, bool bAllowTearing)
+    {
+        if (bAllowTearing && iSyncInterval == 0 && !(iFlags & DXGI_PRESENT_TEST))
+            iFlags |= DXGI_PRESENT_ALLOW_TEARING;
+        return iFlags;
+    }
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <safetyhook.hpp>
+
+// Profiler symbol map.
+// Sampling profilers see hook stubs and trampolines as anonymous RX memory and the game's code as bare offsets into
+// the executable. The fix records every signature match and every stub it installs, then writes them out once hooks
+// are in place: a perf map ("start size name", what perf and most JIT-aware profilers read for anonymous code) and a
+// CSV with every symbol. Hooks are named after the signature they were installed at, e.g. HUD.Backgrounds3.
+namespace SymbolMap
+{
+    enum class Kind { Site, Function, Stub, Trampoline };
+
+    struct Symbol {
+        Kind kind;
+        uintptr_t iAddress;
+        size_t iSize;
+        std::string sName;
+        std::string sHook;      // Hook the symbol belongs to, every hook inside it for functions
+    };
+
+    struct Hook {
+        std::string sName;      // Empty for game hooks, resolved from the nearest signature match
+        const char* sType;      // "mid", "light" or "inline"
+        uintptr_t iTarget;
+        size_t iPatchedSize;
+        uintptr_t iStub;
+        size_t iStubSize;
+        uintptr_t iTrampoline;
+        size_t iTrampolineSize;
+    };
+
+    // Set before hooks are installed. Without it nothing is recorded.
+    inline bool bEnabled = false;
+
+    inline std::mutex mutex{};
+    inline std::map<uintptr_t, std::string> sites{};
+    inline std::vector<Hook> hooks{};
+
+    inline const char* KindName(Kind kind)
+    {
+        switch (kind) {
+        case Kind::Site: return "site";
+        case Kind::Function: return "function";
+        case Kind::Stub: return "stub";
+        default: return "trampoline";
+        }
+    }
+
+    // Signature match, named Feature.Name with the feature prefix dropped from the name (HUDBackgrounds3 -> HUD.Backgrounds3)
+    inline void AddSite(const void* address, const char* sFeature, const char* sName)
+    {
+        if (!bEnabled || !address)
+            return;
+
+        std::string sShortName = sName;
+        size_t iFeatureLength = strlen(sFeature);
+        if (sShortName.size() > iFeatureLength && sShortName.compare(0, iFeatureLength, sFeature) == 0)
+            sShortName.erase(0, iFeatureLength);
+
+        std::scoped_lock lock(mutex);
+        sites[reinterpret_cast<uintptr_t>(address)] = std::string(sFeature) + "." + sShortName;
+    }
+
+    inline void AddHook(Hook hook)
+    {
+        if (!bEnabled || !hook.iTarget)
+            return;
+
+        std::scoped_lock lock(mutex);
+        hooks.push_back(std::move(hook));
+    }
+
+    // SafetyHookMid doesn't expose its stub or trampoline, so they are recovered from the vendored safetyhook's x64
+    // layout: the target starts with either an E9 into the trampoline epilogue's "jmp [rip]" to the stub, or that
+    // "jmp [rip]" itself, and the 391-byte stub keeps the trampoline address in its last 8 bytes.
+    // HookArena uses the same layout to advance its cursor past every hook it hands memory to.
+    inline bool DecodeMid(const SafetyHookMid& hook, Hook& decoded, const char* sName = "")
+    {
+        if (!hook)
+            return false;
+
+        constexpr size_t iMidStubSize = 391;
+        constexpr size_t iJmpFFSize = 6;
+        const uint8_t* target = hook.target();
+        const uint8_t* jump = target;
+        if (target[0] == 0xE9)
+            jump = target + 5 + *reinterpret_cast<const int32_t*>(target + 1);
+        if (jump[0] != 0xFF || jump[1] != 0x25)
+            return false;
+
+        const uint8_t* slot = jump + iJmpFFSize + *reinterpret_cast<const int32_t*>(jump + 2);
+        uintptr_t iStub = *reinterpret_cast<const uintptr_t*>(slot);
+        uintptr_t iTrampoline = *reinterpret_cast<const uintptr_t*>(iStub + iMidStubSize - 8);
+
+        // Only the E9 form tells us where the trampoline ends, otherwise it's the copied bytes plus "jmp [rip]; dq"
+        size_t iTrampolineSize = hook.original_bytes().size() + iJmpFFSize + 8;
+        if (target[0] == 0xE9 && reinterpret_cast<uintptr_t>(slot) + 8 > iTrampoline)
+            iTrampolineSize = reinterpret_cast<uintptr_t>(slot) + 8 - iTrampoline;
+
+        decoded = { sName, "mid", hook.target_address(), hook.original_bytes().size(), iStub, iMidStubSize, iTrampoline, iTrampolineSize };
+        return true;
+    }
+
+    inline void AddMid(const SafetyHookMid& hook, const char* sName = "")
+    {
+        Hook decoded{};
+        if (bEnabled && DecodeMid(hook, decoded, sName))
+            AddHook(std::move(decoded));
+    }
+
+    inline void AddInline(const char* sName, const SafetyHookInline& hook)
+    {
+        if (!bEnabled || !hook)
+            return;
+
+        AddHook({ sName, "inline", hook.target_address(), hook.original_bytes().size(), 0, 0, hook.trampoline().address(), hook.trampoline().size() });
+    }
+
+    // Closest signature match within a few instructions, hooks sit at or just around the match
+    inline std::string HookName(uintptr_t iTarget, uintptr_t iModuleBase)
+    {
+        constexpr uintptr_t iMaxDistance = 0x100;
+        const std::string* sClosest = nullptr;
+        uintptr_t iClosestAddress = 0;
+        uintptr_t iClosestDistance = iMaxDistance + 1;
+        for (auto it = sites.lower_bound(iTarget > iMaxDistance ? iTarget - iMaxDistance : 0); it != sites.end() && it->first <= iTarget + iMaxDistance; ++it) {
+            uintptr_t iDistance = it->first > iTarget ? it->first - iTarget : iTarget - it->first;
+            if (iDistance < iClosestDistance) {
+                sClosest = &it->second;
+                iClosestAddress = it->first;
+                iClosestDistance = iDistance;
+            }
+        }
+
+        char sBuffer[64];
+        if (!sClosest) {
+            snprintf(sBuffer, sizeof(sBuffer), "Hook.%llx", (unsigned long long)(iTarget - iModuleBase));
+            return sBuffer;
+        }
+        if (iClosestAddress == iTarget)
+            return *sClosest;
+
+        snprintf(sBuffer, sizeof(sBuffer), "%c0x%llx", iTarget > iClosestAddress ? '+' : '-', (unsigned long long)iClosestDistance);
+        return *sClosest + sBuffer;
+    }
+
+    // Game symbols are named after the executable, fix symbols after the fix
+    inline std::vector<Symbol> Build(HMODULE module, const std::string& sExeName, const std::string& sFixName)
+    {
+        std::scoped_lock lock(mutex);
+        uintptr_t iModuleBase = reinterpret_cast<uintptr_t>(module);
+        uintptr_t iModuleEnd = iModuleBase + reinterpret_cast<PIMAGE_NT_HEADERS>(iModuleBase + reinterpret_cast<PIMAGE_DOS_HEADER>(module)->e_lfanew)->OptionalHeader.SizeOfImage;
+        std::vector<Symbol> symbols{};
+        std::map<uintptr_t, Symbol> functions{};
+
+        for (const Hook& hook : hooks) {
+            std::string sHook = hook.sName.empty() ? HookName(hook.iTarget, iModuleBase) : hook.sName;
+            bool bGame = hook.iTarget >= iModuleBase && hook.iTarget < iModuleEnd;
+            symbols.push_back({ Kind::Site, hook.iTarget, hook.iPatchedSize, (bGame ? sExeName + "!" : "") + sHook + ".site", sHook });
+            if (hook.iStub)
+                symbols.push_back({ Kind::Stub, hook.iStub, hook.iStubSize, sFixName + "!" + sHook + "." + hook.sType + "_stub", sHook });
+            if (hook.iTrampoline)
+                symbols.push_back({ Kind::Trampoline, hook.iTrampoline, hook.iTrampolineSize, sFixName + "!" + sHook + ".trampoline", sHook });
+
+            // Unwind data gives the game function around the hook, one symbol per function listing every hook in it
+            DWORD64 iImageBase = 0;
+            PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(hook.iTarget, &iImageBase, nullptr);
+            if (!function || iImageBase != iModuleBase)
+                continue;
+
+            uintptr_t iStart = iModuleBase + function->BeginAddress;
+            auto [entry, bInserted] = functions.try_emplace(iStart, Symbol{ Kind::Function, iStart, function->EndAddress - function->BeginAddress, "", "" });
+            entry->second.sHook += (bInserted ? "" : "/") + sHook;
+        }
+
+        for (auto& [iStart, function] : functions) {
+            char sBuffer[64];
+            snprintf(sBuffer, sizeof(sBuffer), "!sub_%llx [", (unsigned long long)iStart);
+            function.sName = sExeName + sBuffer + function.sHook + "]";
+            symbols.push_back(std::move(function));
+        }
+
+        std::sort(symbols.begin(), symbols.end(), [](const Symbol& a, const Symbol& b) { return a.iAddress < b.iAddress; });
+        return symbols;
+    }
+
+    // perf-<pid>.map format. Sites are left out when their function is known so no two entries overlap.
+    inline void WritePerfMap(std::ostream& stream, const std::vector<Symbol>& symbols)
+    {
+        stream << std::hex;
+        for (const Symbol& symbol : symbols) {
+            if (symbol.kind == Kind::Site) {
+                bool bInFunction = std::any_of(symbols.begin(), symbols.end(), [&](const Symbol& function) {
+                    return function.kind == Kind::Function && symbol.iAddress >= function.iAddress && symbol.iAddress < function.iAddress + function.iSize;
+                });
+                if (bInFunction)
+                    continue;
+            }
+            stream << symbol.iAddress << " " << symbol.iSize << " " << symbol.sName << "\n";
+        }
+        stream << std::dec;
+    }
+
+    inline void WriteCsv(std::ostream& stream, const std::vector<Symbol>& symbols, HMODULE module)
+    {
+        uintptr_t iModuleBase = reinterpret_cast<uintptr_t>(module);
+        uintptr_t iModuleEnd = iModuleBase + reinterpret_cast<PIMAGE_NT_HEADERS>(iModuleBase + reinterpret_cast<PIMAGE_DOS_HEADER>(module)->e_lfanew)->OptionalHeader.SizeOfImage;
+
+        stream << "kind,name,hook,address,size,rva\n";
+        for (const Symbol& symbol : symbols) {
+            char sAddress[64];
+            snprintf(sAddress, sizeof(sAddress), "0x%llx,%zu,", (unsigned long long)symbol.iAddress, symbol.iSize);
+            stream << KindName(symbol.kind) << "," << symbol.sName << "," << symbol.sHook << "," << sAddress;
+            if (symbol.iAddress >= iModuleBase && symbol.iAddress < iModuleEnd)
+                stream << "0x" << std::hex << symbol.iAddress - iModuleBase << std::dec;
+            stream << "\n";
+        }
+    }
+}
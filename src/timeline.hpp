@@ -0,0 +1,173 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <vector>
+
+// Timeline recorder for frame and hook events.
+// Events are appended lock-free into a preallocated buffer while a capture is running and written out afterwards as
+// Chrome Trace Event JSON (chrome://tracing, Perfetto, Speedscope).
+namespace Timeline
+{
+    struct Event {
+        const char* sName;
+        char cPhase;            // 'B' begin, 'E' end, 'i' instant, 'X' complete
+        DWORD iThreadId;
+        int64_t iTimestamp;     // QPC ticks
+        int64_t iDuration;      // QPC ticks, 'X' only
+        bool bFlagged;          // Long frame
+    };
+
+    inline constexpr size_t iMaxEvents = 1 << 20;
+
+    inline std::vector<Event> events{};
+    inline std::atomic<size_t> iEventCount = 0;
+    inline std::atomic<bool> bRecording = false;
+    inline int64_t iStartTime = 0;
+    inline int64_t iEndTime = 0;
+    inline int64_t iFrequency = 1;
+    inline int64_t iLastFrameTime = 0;
+    inline int64_t iLongFrameTicks = 0;
+    inline uint32_t iLongFrames = 0;
+
+    inline int64_t Now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    // Called from hook sites, so the not-recording path is a single relaxed load.
+    inline void Record(const char* sName, char cPhase, int64_t iTimestamp, int64_t iDuration = 0, bool bFlagged = false)
+    {
+        if (!bRecording.load(std::memory_order_relaxed))
+            return;
+
+        if (iTimestamp >= iEndTime) {
+            bRecording.store(false, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t iIndex = iEventCount.fetch_add(1, std::memory_order_relaxed);
+        if (iIndex < iMaxEvents)
+            events[iIndex] = { sName, cPhase, GetCurrentThreadId(), iTimestamp, iDuration, bFlagged };
+    }
+
+    inline void Instant(const char* sName)
+    {
+        if (bRecording.load(std::memory_order_relaxed))
+            Record(sName, 'i', Now());
+    }
+
+    inline void Begin(const char* sName)
+    {
+        if (bRecording.load(std::memory_order_relaxed))
+            Record(sName, 'B', Now());
+    }
+
+    inline void End(const char* sName)
+    {
+        if (bRecording.load(std::memory_order_relaxed))
+            Record(sName, 'E', Now());
+    }
+
+    // Begin/End pair around the enclosing block. The End is only written if the Begin was, so a capture starting
+    // or stopping mid-block never leaves an unmatched end event.
+    struct Scope {
+        const char* sName;
+        bool bBegun;
+
+        explicit Scope(const char* sName) : sName(sName), bBegun(bRecording.load(std::memory_order_relaxed))
+        {
+            if (bBegun)
+                Begin(sName);
+        }
+
+        ~Scope()
+        {
+            if (bBegun)
+                End(sName);
+        }
+    };
+
+    // Frame boundary. Emits the previous frame as a complete event and flags it if it ran long.
+    inline void Frame()
+    {
+        if (!bRecording.load(std::memory_order_relaxed))
+            return;
+
+        int64_t iNow = Now();
+        if (iLastFrameTime) {
+            int64_t iDuration = iNow - iLastFrameTime;
+            bool bLongFrame = iLongFrameTicks && iDuration > iLongFrameTicks;
+            Record("Frame", 'X', iLastFrameTime, iDuration, bLongFrame);
+            if (bLongFrame) {
+                Record("Long Frame", 'i', iNow);
+                iLongFrames++;
+            }
+        }
+        iLastFrameTime = iNow;
+    }
+
+    // fLongFrameTime = frametime in seconds above which a frame is flagged
+    inline bool Start(float fSeconds, float fLongFrameTime)
+    {
+        if (bRecording.load())
+            return false;
+
+        if (events.empty())
+            events.resize(iMaxEvents);
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        iFrequency = frequency.QuadPart;
+        iLongFrameTicks = static_cast<int64_t>(fLongFrameTime * iFrequency);
+        iLongFrames = 0;
+        iLastFrameTime = 0;
+        iEventCount = 0;
+        iStartTime = Now();
+        iEndTime = iStartTime + static_cast<int64_t>(fSeconds * iFrequency);
+        bRecording = true;
+        return true;
+    }
+
+    inline void Stop()
+    {
+        bRecording = false;
+    }
+
+    inline size_t DroppedEvents()
+    {
+        size_t iCount = iEventCount.load();
+        return iCount > iMaxEvents ? iCount - iMaxEvents : 0;
+    }
+
+    inline bool Write(const std::filesystem::path& path)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+
+        auto toMicroseconds = [](int64_t iTicks) { return (double)iTicks * 1000000.0 / (double)iFrequency; };
+
+        DWORD iProcessId = GetCurrentProcessId();
+        size_t iCount = std::min(iEventCount.load(), iMaxEvents);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t i = 0; i < iCount; i++) {
+            const Event& event = events[i];
+            file << (i ? ",\n" : "") << "{\"name\":\"" << event.sName << "\",\"ph\":\"" << event.cPhase
+                << "\",\"pid\":" << iProcessId << ",\"tid\":" << event.iThreadId
+                << ",\"ts\":" << std::fixed << toMicroseconds(event.iTimestamp - iStartTime);
+            if (event.cPhase == 'X')
+                file << ",\"dur\":" << toMicroseconds(event.iDuration);
+            if (event.cPhase == 'i')
+                file << ",\"s\":\"t\"";
+            if (event.bFlagged)
+                file << ",\"cname\":\"terrible\",\"args\":{\"long_frame\":true}";
+            file << "}";
+        }
+        file << "\n]}\n";
+        return true;
+    }
+}
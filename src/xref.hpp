@@ -0,0 +1,94 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <mutex>
+#include <span>
+#include <vector>
+#include <Zydis.h>
+
+// Cross-reference list of the game image.
+// One linear decode of the executable sections records every RIP-relative memory operand and rel32 call/jmp in
+// image order. It is only built when an absolute signature fails to match, see ReportSignatureCandidate() in
+// dllmain.cpp, which walks every reference once, so nothing is sorted or indexed by target.
+namespace Xref
+{
+    struct Reference {
+        uint32_t iTarget;   // RVA being referenced
+        uint32_t iSource;   // RVA of the referencing instruction
+    };
+
+    class Index {
+    public:
+        void Build(void* module)
+        {
+            m_base = reinterpret_cast<uint8_t*>(module);
+            auto dosHeader = (PIMAGE_DOS_HEADER)module;
+            auto ntHeaders = (PIMAGE_NT_HEADERS)(m_base + dosHeader->e_lfanew);
+            m_imageSize = ntHeaders->OptionalHeader.SizeOfImage;
+
+            ZydisDecoder decoder{};
+            ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+
+            auto section = IMAGE_FIRST_SECTION(ntHeaders);
+            for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; i++, section++) {
+                if (section->Characteristics & IMAGE_SCN_MEM_EXECUTE)
+                    DecodeSection(decoder, section->VirtualAddress, section->Misc.VirtualSize);
+            }
+        }
+
+        size_t Size() const { return m_references.size(); }
+
+        // Every reference, in image order
+        std::span<const Reference> References() const { return m_references; }
+
+    private:
+        uint8_t* m_base{};
+        size_t m_imageSize{};
+        std::vector<Reference> m_references{};
+
+        void DecodeSection(const ZydisDecoder& decoder, uint32_t iStart, uint32_t iSize)
+        {
+            ZydisDecodedInstruction ix{};
+            for (uint32_t iRva = iStart; iRva < iStart + iSize;) {
+                uint8_t* ip = m_base + iRva;
+                if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&decoder, nullptr, ip, std::min<size_t>(15, iStart + iSize - iRva), &ix))) {
+                    // Data or padding in the code section, resync on the next byte
+                    iRva++;
+                    continue;
+                }
+
+                int64_t iOffset = 0;
+                bool bReference = false;
+                if ((ix.attributes & ZYDIS_ATTRIB_HAS_MODRM) && ix.raw.modrm.mod == 0 && ix.raw.modrm.rm == 5 && ix.raw.disp.size == 32) {
+                    // [rip+disp32]
+                    iOffset = ix.raw.disp.value;
+                    bReference = true;
+                }
+                else if ((ix.attributes & ZYDIS_ATTRIB_IS_RELATIVE) && ix.raw.imm[0].is_relative && ix.raw.imm[0].size == 32) {
+                    // call/jmp/jcc rel32
+                    iOffset = ix.raw.imm[0].value.s;
+                    bReference = true;
+                }
+
+                if (bReference) {
+                    int64_t iTarget = (int64_t)iRva + ix.length + iOffset;
+                    if (iTarget >= 0 && iTarget < (int64_t)m_imageSize)
+                        m_references.push_back({ static_cast<uint32_t>(iTarget), iRva });
+                }
+
+                iRva += ix.length;
+            }
+        }
+    };
+
+    // Built once on first use
+    inline Index& Get(void* module)
+    {
+        static Index index{};
+        static std::once_flag built{};
+        std::call_once(built, [&]() { index.Build(module); });
+        return index;
+    }
+}
@@ -0,0 +1,256 @@
+// allocbench - stress test and benchmark for the heap allocator in src/allocator.hpp.
+//
+// Every thread keeps a pool of live allocations and randomly frees and replaces them with sizes drawn from a
+// game-like distribution (mostly small, occasional large), with a share of blocks freed by a different thread than
+// the one that allocated them. Block contents are checked on free to catch overlapping or corrupted blocks.
+// The same workload runs against the system malloc for comparison. Before that, HeapReAlloc()'s contract is checked:
+// reported sizes are the requested ones and HEAP_ZERO_MEMORY reallocs clear grown bytes, also when growing in place.
+//
+// Build: g++ -std=c++20 -O2 -pthread -o allocbench tools/allocbench/allocbench.cpp
+// Usage: allocbench [threads] [operations per thread]
+
+#include "../../src/allocator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Block {
+    void* p = nullptr;
+    size_t iSize = 0;
+    uint8_t iTag = 0;
+};
+
+struct Result {
+    double fSeconds = 0.0;
+    double fP50 = 0.0;
+    double fP99 = 0.0;
+    double fP999 = 0.0;
+    double fMax = 0.0;
+    size_t iCorrupt = 0;
+};
+
+static size_t RandomSize(std::mt19937& rng)
+{
+    uint32_t iRoll = rng() % 1000;
+    if (iRoll < 700)
+        return 8 + rng() % 120;         // Small objects
+    if (iRoll < 950)
+        return 128 + rng() % 896;       // Components, strings
+    if (iRoll < 995)
+        return 1024 + rng() % 15360;    // Buffers
+    return 32768 + rng() % 65536;       // Above the largest class, falls back
+}
+
+template<typename AllocFn, typename FreeFn>
+static Result Run(int iThreads, size_t iOperations, AllocFn allocate, FreeFn release)
+{
+    // Blocks handed between threads to exercise cross-thread frees
+    std::mutex exchangeMutex;
+    std::vector<Block> exchange;
+
+    std::vector<std::vector<double>> latencies(iThreads);
+    std::vector<size_t> corrupt(iThreads, 0);
+
+    auto check = [](const Block& block) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(block.p);
+        return bytes[0] == block.iTag && bytes[block.iSize - 1] == block.iTag && bytes[block.iSize / 2] == block.iTag;
+    };
+
+    auto worker = [&](int iThread) {
+        std::mt19937 rng(1234 + iThread);
+        std::vector<Block> live(2048);
+        auto& samples = latencies[iThread];
+        samples.reserve(iOperations);
+
+        for (size_t i = 0; i < iOperations; i++) {
+            Block& slot = live[rng() % live.size()];
+            if (slot.p) {
+                if (!check(slot))
+                    corrupt[iThread]++;
+
+                if (rng() % 16 == 0) {
+                    std::scoped_lock lock(exchangeMutex);
+                    exchange.push_back(slot);
+                }
+                else {
+                    release(slot.p, slot.iSize);
+                }
+                slot = {};
+            }
+
+            if (rng() % 64 == 0) {
+                Block foreign{};
+                {
+                    std::scoped_lock lock(exchangeMutex);
+                    if (!exchange.empty()) {
+                        foreign = exchange.back();
+                        exchange.pop_back();
+                    }
+                }
+                if (foreign.p) {
+                    if (!check(foreign))
+                        corrupt[iThread]++;
+                    release(foreign.p, foreign.iSize);
+                }
+            }
+
+            slot.iSize = RandomSize(rng);
+            slot.iTag = static_cast<uint8_t>(rng());
+            auto start = std::chrono::steady_clock::now();
+            slot.p = allocate(slot.iSize);
+            samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            memset(slot.p, slot.iTag, slot.iSize);
+        }
+
+        for (Block& block : live) {
+            if (block.p) {
+                if (!check(block))
+                    corrupt[iThread]++;
+                release(block.p, block.iSize);
+            }
+        }
+        HeapAllocator::FlushThreadCache();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < iThreads; i++)
+        threads.emplace_back(worker, i);
+    for (auto& thread : threads)
+        thread.join();
+    Result result{};
+    result.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const Block& block : exchange) {
+        if (!check(block))
+            result.iCorrupt++;
+        release(block.p, block.iSize);
+    }
+    HeapAllocator::FlushThreadCache();
+
+    std::vector<double> all;
+    for (auto& samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    result.fP50 = all[all.size() / 2];
+    result.fP99 = all[all.size() * 99 / 100];
+    result.fP999 = all[all.size() * 999 / 1000];
+    result.fMax = all.back();
+    for (size_t iCount : corrupt)
+        result.iCorrupt += iCount;
+    return result;
+}
+
+static bool AllZero(const void* p, size_t iFrom, size_t iTo)
+{
+    for (size_t i = iFrom; i < iTo; i++) {
+        if (static_cast<const uint8_t*>(p)[i] != 0)
+            return false;
+    }
+    return true;
+}
+
+// HeapAlloc(HEAP_ZERO_MEMORY, 20) then HeapReAlloc(HEAP_ZERO_MEMORY, ...) the way RtlReAllocateHeap_hk() does it
+static size_t CheckReallocContract()
+{
+    size_t iFailures = 0;
+    auto expect = [&](bool bCondition, const char* sWhat) {
+        if (!bCondition) {
+            fprintf(stderr, "Realloc contract: %s\n", sWhat);
+            iFailures++;
+        }
+    };
+
+    // Leave stale bytes in the block the next 32-byte class allocation gets back from the thread cache
+    void* stale = HeapAllocator::Allocate(32);
+    memset(stale, 0xCD, 32);
+    HeapAllocator::Free(stale);
+
+    void* p = HeapAllocator::Allocate(20);
+    expect(p == stale, "20-byte block didn't reuse the freed 32-byte block");
+    memset(p, 0, 20);
+    expect(HeapAllocator::Size(p) == 20, "size of a 20-byte block isn't 20");
+    expect(HeapAllocator::Capacity(p) == 32, "20-byte block isn't in the 32-byte class");
+
+    void* q = HeapAllocator::Reallocate(p, 30, true);
+    expect(q == p, "20 -> 30 bytes moved the block");
+    expect(HeapAllocator::Size(q) == 30, "size after growing in place isn't 30");
+    expect(AllZero(q, 0, 30), "bytes 20-29 not cleared after growing in place");
+
+    // Shrink and grow again, bytes past the smaller size are cleared again
+    memset(q, 0xEE, 30);
+    q = HeapAllocator::Reallocate(q, 24, true);
+    expect(q == p && HeapAllocator::Size(q) == 24, "30 -> 24 bytes didn't stay in place");
+    expect(HeapAllocator::Resize(q, 30, true) && HeapAllocator::Size(q) == 30, "in-place-only resize to 30 failed");
+    expect(AllZero(q, 24, 30), "bytes 24-29 not cleared after shrinking and growing in place");
+    expect(!HeapAllocator::Resize(q, 33, true), "in-place-only resize past the size class succeeded");
+
+    // Growing into another class keeps the contents and clears the rest
+    void* r = HeapAllocator::Reallocate(q, 100, true);
+    expect(r && r != q, "30 -> 100 bytes didn't move the block");
+    if (r) {
+        expect(HeapAllocator::Size(r) == 100, "size after moving isn't 100");
+        expect(static_cast<uint8_t*>(r)[0] == 0xEE && static_cast<uint8_t*>(r)[23] == 0xEE, "contents lost when moving");
+        expect(AllZero(r, 30, 100), "bytes 30-99 not cleared after moving");
+        HeapAllocator::Free(r);
+    }
+
+    HeapAllocator::FlushThreadCache();
+    return iFailures;
+}
+
+static void Print(const char* sName, const Result& result, size_t iTotalOperations)
+{
+    printf("%-14s %8.3f s  %10.0f ops/s  alloc ns p50 %6.0f  p99 %6.0f  p99.9 %7.0f  max %9.0f  corrupt %zu\n",
+        sName, result.fSeconds, (double)iTotalOperations / result.fSeconds, result.fP50, result.fP99, result.fP999, result.fMax, result.iCorrupt);
+}
+
+int main(int argc, char** argv)
+{
+    int iThreads = argc > 1 ? atoi(argv[1]) : (int)std::max(2u, std::thread::hardware_concurrency());
+    size_t iOperations = argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000;
+
+    if (!HeapAllocator::Initialize()) {
+        fprintf(stderr, "Failed to reserve allocator address space\n");
+        return 2;
+    }
+
+    size_t iContractFailures = CheckReallocContract();
+    printf("Realloc contract: %s\n", iContractFailures ? "FAILED" : "ok");
+    printf("%d threads, %zu operations per thread\n\n", iThreads, iOperations);
+
+    Result system = Run(iThreads, iOperations,
+        [](size_t iSize) { return malloc(iSize); },
+        [](void* p, size_t) { free(p); });
+    Print("malloc", system, iThreads * iOperations);
+
+    Result bundled = Run(iThreads, iOperations,
+        [](size_t iSize) {
+            void* p = HeapAllocator::Allocate(iSize);
+            return p ? p : malloc(iSize);
+        },
+        [](void* p, size_t iSize) {
+            if (!HeapAllocator::Owns(p)) {
+                free(p);
+                return;
+            }
+            if (HeapAllocator::Size(p) != iSize || HeapAllocator::Capacity(p) < iSize)
+                fprintf(stderr, "Wrong size: %zu (class %zu) for %zu\n", HeapAllocator::Size(p), HeapAllocator::Capacity(p), iSize);
+            HeapAllocator::Free(p);
+        });
+    Print("HeapAllocator", bundled, iThreads * iOperations);
+
+    auto& stats = HeapAllocator::stats;
+    printf("\nallocations %llu  frees %llu  fallbacks %llu  refills %llu  releases %llu  committed %zu KB\n",
+        (unsigned long long)stats.iAllocations.load(), (unsigned long long)stats.iFrees.load(), (unsigned long long)stats.iFallbacks.load(),
+        (unsigned long long)stats.iRefills.load(), (unsigned long long)stats.iReleases.load(), HeapAllocator::CommittedBytes() / 1024);
+
+    bool bFailed = iContractFailures || system.iCorrupt || bundled.iCorrupt || stats.iAllocations.load() != stats.iFrees.load();
+    return bFailed ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Minimal PE32+ loader for the offline tools.
+// Maps an executable from disk with its in-memory section layout so RVAs, signatures and RIP-relative
+// displacements behave exactly as they do inside the running game. No imports or relocations are processed.
+namespace PE
+{
+    struct Section {
+        std::string sName;
+        uint32_t iVirtualAddress;
+        uint32_t iVirtualSize;
+        uint32_t iRawOffset;
+        uint32_t iRawSize;
+        uint32_t iCharacteristics;
+    };
+
+    inline constexpr uint32_t SCN_MEM_EXECUTE = 0x20000000;
+    inline constexpr uint32_t SCN_MEM_READ = 0x40000000;
+
+    struct Image {
+        std::vector<uint8_t> data{};        // SizeOfImage bytes, sections at their virtual addresses
+        std::vector<Section> sections{};
+        uint64_t iImageBase = 0;
+        uint32_t iTimestamp = 0;
+        uint32_t iImageSize = 0;
+
+        uint8_t* Base() { return data.data(); }
+        const uint8_t* Base() const { return data.data(); }
+    };
+
+    template<typename T>
+    T Read(const std::vector<uint8_t>& file, size_t iOffset)
+    {
+        T value{};
+        if (iOffset + sizeof(T) <= file.size())
+            memcpy(&value, file.data() + iOffset, sizeof(T));
+        return value;
+    }
+
+    // Returns an error message, empty on success
+    inline std::string Load(const std::string& sPath, Image& image)
+    {
+        std::ifstream stream(sPath, std::ios::binary);
+        if (!stream)
+            return "could not open " + sPath;
+        std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        if (Read<uint16_t>(file, 0) != 0x5A4D)
+            return "missing MZ header";
+
+        uint32_t iNtHeaders = Read<uint32_t>(file, 0x3C);
+        if (Read<uint32_t>(file, iNtHeaders) != 0x00004550)
+            return "missing PE header";
+
+        size_t iFileHeader = iNtHeaders + 4;
+        uint16_t iSectionCount = Read<uint16_t>(file, iFileHeader + 2);
+        image.iTimestamp = Read<uint32_t>(file, iFileHeader + 4);
+        uint16_t iOptionalHeaderSize = Read<uint16_t>(file, iFileHeader + 16);
+
+        size_t iOptionalHeader = iFileHeader + 20;
+        if (Read<uint16_t>(file, iOptionalHeader) != 0x20B)
+            return "not a PE32+ (x64) image";
+
+        image.iImageBase = Read<uint64_t>(file, iOptionalHeader + 24);
+        image.iImageSize = Read<uint32_t>(file, iOptionalHeader + 56);
+        uint32_t iHeadersSize = Read<uint32_t>(file, iOptionalHeader + 60);
+
+        image.data.assign(image.iImageSize, 0);
+        memcpy(image.data.data(), file.data(), std::min<size_t>({ iHeadersSize, file.size(), image.iImageSize }));
+
+        size_t iSectionTable = iOptionalHeader + iOptionalHeaderSize;
+        for (uint16_t i = 0; i < iSectionCount; i++) {
+            size_t iSection = iSectionTable + i * 40;
+            if (iSection + 40 > file.size())
+                return "truncated section table";
+
+            Section section{};
+            section.sName.assign(reinterpret_cast<const char*>(file.data() + iSection), strnlen(reinterpret_cast<const char*>(file.data() + iSection), 8));
+            section.iVirtualSize = Read<uint32_t>(file, iSection + 8);
+            section.iVirtualAddress = Read<uint32_t>(file, iSection + 12);
+            section.iRawSize = Read<uint32_t>(file, iSection + 16);
+            section.iRawOffset = Read<uint32_t>(file, iSection + 20);
+            section.iCharacteristics = Read<uint32_t>(file, iSection + 36);
+
+            if (section.iVirtualAddress >= image.iImageSize || section.iRawOffset > file.size())
+                return "section " + section.sName + " is outside the image";
+
+            size_t iCopySize = std::min<size_t>({ section.iRawSize, section.iVirtualSize ? section.iVirtualSize : section.iRawSize, file.size() - section.iRawOffset, image.iImageSize - section.iVirtualAddress });
+            memcpy(image.data.data() + section.iVirtualAddress, file.data() + section.iRawOffset, iCopySize);
+            image.sections.push_back(section);
+        }
+        return {};
+    }
+
+    // File offset backing an RVA range, 0 if any of it is headers-only, zero-fill or outside the image
+    inline size_t FileOffset(const Image& image, uint32_t iRva, size_t iSize)
+    {
+        for (const Section& section : image.sections) {
+            uint32_t iBacked = std::min(section.iRawSize, section.iVirtualSize ? section.iVirtualSize : section.iRawSize);
+            if (iRva >= section.iVirtualAddress && (uint64_t)iRva + iSize <= (uint64_t)section.iVirtualAddress + iBacked)
+                return section.iRawOffset + (iRva - section.iVirtualAddress);
+        }
+        return 0;
+    }
+}
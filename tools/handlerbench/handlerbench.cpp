@@ -0,0 +1,322 @@
+// handlerbench - checks and times the mid-hook handlers in src/handlers.hpp outside the game.
+//
+// Every handler runs on a synthetic SafetyHookContext, with the stack or struct memory it touches laid out the way
+// its hook site has it, at 16:9, 21:9, 32:9 and 4:3. Outputs are compared with the values the fix has to produce at
+// each layout (background rects covering the screen, HUD pillarbox/letterbox offsets, the 4:3 FOV correction), then
+// each handler is timed in a loop with the cost of resetting its inputs subtracted.
+//
+// Build: g++ -std=c++23 -O2 -I external/safetyhook -o handlerbench tools/handlerbench/handlerbench.cpp
+// Usage: handlerbench [iterations]
+//
+// Exit code is 0 when every output matched, 1 otherwise.
+
+#include "../../src/handlers.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Owned by dllmain.cpp in the fix
+float fAspectRatio;
+float fNativeAspect = 16.0f / 9.0f;
+float fAspectMultiplier;
+float fHUDWidth;
+float fHUDHeight;
+float fHUDWidthOffset;
+float fHUDHeightOffset;
+float fGameplayFOVMulti = 1.25f;
+float fCurrentFrametime = 1.0f / 60.0f;
+float fFramerateCap = 60.0f;
+float fAdaptiveMinFramerate = 30.0f;
+float fAdaptiveSmoothing = 1.0f;
+int iCurrentResX;
+int iCurrentResY;
+
+using Rect = std::array<float, 4>;
+
+// Expected results for a 1920x1080 UI rect and the HUD at one resolution
+struct Layout {
+    const char* sName;
+    int iResX;
+    int iResY;
+    Rect background;        // { x, y, width, height } from { 0, 0, 1920, 1080 }
+    Rect capture;           // { left, top, right, bottom } from { 0, 0, 1920, 1080 }
+    Rect menu;              // { left, top, right, bottom } from { 0, 0, resX, resY }, in screen space
+    float fGlobalFOV;       // From 1 radian
+};
+
+static const Layout layouts[] = {
+    { "16:9", 1920, 1080, { 0, 0, 1920, 1080 }, { 0, 0, 1920, 1080 }, { 0, 0, 1920, 1080 }, 1.0f },
+    { "21:9", 2560, 1080, { -320, 0, 2560, 1080 }, { -320, 0, 2240, 1080 }, { 320, 0, 2240, 1080 }, 1.0f },
+    { "32:9", 3840, 1080, { -960, 0, 3840, 1080 }, { -960, 0, 2880, 1080 }, { 960, 0, 2880, 1080 }, 1.0f },
+    { "4:3", 1440, 1080, { 0, -180, 1920, 1440 }, { 0, -180, 1920, 1260 }, { 0, 135, 1440, 945 }, 1.2590707f },
+};
+
+// Stand-in for the stack or struct the handler's base register points at
+struct Scratch {
+    alignas(16) uint8_t memory[0x200];
+    uint8_t iControllerTarget1;
+    uint8_t iControllerTarget2;
+
+    float& F(size_t iOffset) { return *reinterpret_cast<float*>(memory + iOffset); }
+    float F(size_t iOffset) const { return *reinterpret_cast<const float*>(memory + iOffset); }
+    void SetRect(size_t iOffset, const Rect& rect) { memcpy(memory + iOffset, rect.data(), sizeof(rect)); }
+    Rect GetRect(size_t iOffset) const
+    {
+        Rect rect{};
+        memcpy(rect.data(), memory + iOffset, sizeof(rect));
+        return rect;
+    }
+};
+
+struct Case {
+    const char* sName;
+    void (*handler)(SafetyHookContext&);
+    void (*prepare)(const Layout&, SafetyHookContext&, Scratch&);
+    std::string (*verify)(const Layout&, const SafetyHookContext&, const Scratch&);
+};
+
+static uintptr_t Base(Scratch& scratch)
+{
+    return reinterpret_cast<uintptr_t>(scratch.memory);
+}
+
+static bool Near(float fValue, float fExpected)
+{
+    return std::fabs(fValue - fExpected) <= 0.001f * std::max(1.0f, std::fabs(fExpected));
+}
+
+static std::string CheckValue(const char* sWhat, float fValue, float fExpected)
+{
+    if (Near(fValue, fExpected))
+        return {};
+    char sBuffer[128];
+    snprintf(sBuffer, sizeof(sBuffer), "%s is %g, expected %g", sWhat, fValue, fExpected);
+    return sBuffer;
+}
+
+static std::string CheckRect(const Rect& rect, const Rect& expected)
+{
+    for (size_t i = 0; i < rect.size(); i++) {
+        if (!Near(rect[i], expected[i])) {
+            char sBuffer[160];
+            snprintf(sBuffer, sizeof(sBuffer), "rect is { %g, %g, %g, %g }, expected { %g, %g, %g, %g }",
+                rect[0], rect[1], rect[2], rect[3], expected[0], expected[1], expected[2], expected[3]);
+            return sBuffer;
+        }
+    }
+    return {};
+}
+
+static constexpr Rect uiRect = { 0, 0, 1920, 1080 };
+
+// Background rect at base + 0x20, or at rsp + 0x30/0x40 for the sites that keep it on the stack
+template<size_t Offset>
+static void PrepareBackground(const Layout&, SafetyHookContext&, Scratch& scratch) { scratch.SetRect(Offset, uiRect); }
+
+template<size_t Offset>
+static std::string VerifyBackground(const Layout& layout, const SafetyHookContext&, const Scratch& scratch) { return CheckRect(scratch.GetRect(Offset), layout.background); }
+
+static const Case cases[] = {
+    { "AspectRatio", Handlers::AspectRatio,
+        [](const Layout&, SafetyHookContext& ctx, Scratch& scratch) { ctx.rbx = Base(scratch) - 0x100; scratch.F(0xB0) = 16.0f / 9.0f; },
+        [](const Layout& layout, const SafetyHookContext&, const Scratch& scratch) {
+            return CheckValue("[rbx+0x1B0]", scratch.F(0xB0), (float)layout.iResX / layout.iResY);
+        } },
+    { "GlobalFOV", Handlers::GlobalFOV,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm0.f32[0] = 1.0f; },
+        [](const Layout& layout, const SafetyHookContext& ctx, const Scratch&) { return CheckValue("xmm0", ctx.xmm0.f32[0], layout.fGlobalFOV); } },
+    { "GameplayFOV", Handlers::GameplayFOV,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm0.f32[0] = 1.0f; },
+        [](const Layout&, const SafetyHookContext& ctx, const Scratch&) { return CheckValue("xmm0", ctx.xmm0.f32[0], 1.25f); } },
+    { "GameplayLockOnFOV", Handlers::GameplayLockOnFOV,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm7.f32[0] = 1.0f; },
+        [](const Layout&, const SafetyHookContext& ctx, const Scratch&) { return CheckValue("xmm7", ctx.xmm7.f32[0], 1.25f); } },
+    { "FadeWidth", Handlers::FadeWidth,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm0.f32[0] = 0; ctx.xmm1.f32[0] = 0; ctx.xmm2.f32[0] = 1920; },
+        [](const Layout& layout, const SafetyHookContext& ctx, const Scratch&) {
+            std::string sError = CheckValue("xmm0", ctx.xmm0.f32[0], layout.background[0]);
+            if (sError.empty())
+                sError = CheckValue("xmm1", ctx.xmm1.f32[0], layout.background[1]);
+            if (sError.empty())
+                sError = CheckValue("xmm2", ctx.xmm2.f32[0], layout.background[2]);
+            return sError;
+        } },
+    { "FadeHeight", Handlers::FadeHeight,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm2.f32[0] = 1920; ctx.xmm3.f32[0] = 1080; },
+        [](const Layout& layout, const SafetyHookContext& ctx, const Scratch&) { return CheckValue("xmm3", ctx.xmm3.f32[0], layout.background[3]); } },
+    { "PauseCapture", Handlers::PauseCapture,
+        [](const Layout&, SafetyHookContext& ctx, Scratch& scratch) { ctx.rsp = Base(scratch); scratch.SetRect(0x48, uiRect); },
+        [](const Layout& layout, const SafetyHookContext&, const Scratch& scratch) { return CheckRect(scratch.GetRect(0x48), layout.capture); } },
+    { "PauseBackground", Handlers::PauseBackground,
+        [](const Layout&, SafetyHookContext& ctx, Scratch& scratch) {
+            ctx.rcx = Base(scratch);
+            ctx.xmm0.f32[0] = 1080;
+            ctx.xmm1.f32[0] = 1920;
+            scratch.F(0x20) = 0;
+            scratch.F(0x24) = 0;
+        },
+        [](const Layout& layout, const SafetyHookContext& ctx, const Scratch& scratch) {
+            return CheckRect({ scratch.F(0x20), scratch.F(0x24), ctx.xmm1.f32[0], ctx.xmm0.f32[0] }, layout.background);
+        } },
+    { "MissionSelectCapture", Handlers::MissionSelectCapture,
+        [](const Layout&, SafetyHookContext& ctx, Scratch& scratch) { ctx.rsp = Base(scratch); ctx.xmm0.f32[0] = 1920; scratch.SetRect(0x40, uiRect); },
+        [](const Layout& layout, const SafetyHookContext&, const Scratch& scratch) { return CheckRect(scratch.GetRect(0x40), layout.capture); } },
+    { "MissionSelectBackground", Handlers::MissionSelectBackground,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.r8 = Base(scratch); ctx.xmm1.f32[0] = 1920; PrepareBackground<0x20>(layout, ctx, scratch); },
+        VerifyBackground<0x20> },
+    { "MenuBackgrounds", Handlers::MenuBackgrounds,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) {
+            ctx.rsp = Base(scratch);
+            ctx.xmm0.f32[0] = (float)layout.iResX;
+            ctx.xmm1.f32[0] = (float)layout.iResY;
+            scratch.SetRect(0x50, { 0, 0, (float)layout.iResX, (float)layout.iResY });
+        },
+        [](const Layout& layout, const SafetyHookContext&, const Scratch& scratch) { return CheckRect(scratch.GetRect(0x50), layout.menu); } },
+    { "HUDBackgrounds1", Handlers::HUDBackgrounds1,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.rdx = Base(scratch); PrepareBackground<0x20>(layout, ctx, scratch); },
+        VerifyBackground<0x20> },
+    { "HUDBackgrounds2", Handlers::HUDBackgrounds2,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.rsp = Base(scratch); PrepareBackground<0x40>(layout, ctx, scratch); },
+        VerifyBackground<0x40> },
+    { "HUDBackgrounds3", Handlers::HUDBackgrounds3,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.rdx = Base(scratch); PrepareBackground<0x20>(layout, ctx, scratch); },
+        VerifyBackground<0x20> },
+    { "HUDBackgrounds4", Handlers::HUDBackgrounds4,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.rdx = Base(scratch); PrepareBackground<0x20>(layout, ctx, scratch); },
+        VerifyBackground<0x20> },
+    { "HUDBackgrounds5", Handlers::HUDBackgrounds5,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.rsp = Base(scratch); PrepareBackground<0x30>(layout, ctx, scratch); },
+        VerifyBackground<0x30> },
+    { "HUDBackgrounds6", Handlers::HUDBackgrounds6,
+        [](const Layout& layout, SafetyHookContext& ctx, Scratch& scratch) { ctx.r8 = Base(scratch); PrepareBackground<0x20>(layout, ctx, scratch); },
+        VerifyBackground<0x20> },
+    // Framerate handlers don't depend on the layout, they run at 128fps (exact in float) against a 60fps game
+    { "CurrentFrametime", Handlers::CurrentFrametime,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { ctx.xmm4.f32[0] = 1.0f / 128.0f; },
+        [](const Layout&, const SafetyHookContext&, const Scratch&) { return CheckValue("fCurrentFrametime", fCurrentFrametime, 1.0f / 128.0f); } },
+    { "ControllerInputSpeed", Handlers::ControllerInputSpeed,
+        [](const Layout&, SafetyHookContext& ctx, Scratch& scratch) {
+            fCurrentFrametime = 1.0f / 128.0f;
+            ctx.rax = 41;
+            ctx.rflags = 0;
+            scratch.iControllerTarget1 = scratch.iControllerTarget2 = 16;
+            Handlers::ControllerInputTarget1 = &scratch.iControllerTarget1;
+            Handlers::ControllerInputTarget2 = &scratch.iControllerTarget2;
+        },
+        [](const Layout&, const SafetyHookContext& ctx, const Scratch& scratch) -> std::string {
+            // 20 and 16 counts at 60fps become 42 and 34 at 128fps, 41 is below the target so CF is set
+            if (!(ctx.rflags & 1))
+                return "CF clear for count 41 below target 42";
+            if (scratch.iControllerTarget1 != 34 || scratch.iControllerTarget2 != 34)
+                return "input targets are " + std::to_string(scratch.iControllerTarget1) + "/" + std::to_string(scratch.iControllerTarget2) + ", expected 34";
+            return {};
+        } },
+    { "KeyboardInputSpeed", Handlers::KeyboardInputSpeed,
+        [](const Layout&, SafetyHookContext& ctx, Scratch&) { fCurrentFrametime = 1.0f / 128.0f; ctx.xmm1.f32[0] = 1.0f; },
+        [](const Layout&, const SafetyHookContext& ctx, const Scratch&) { return CheckValue("xmm1", ctx.xmm1.f32[0], 60.0f / 128.0f); } },
+};
+
+static void ApplyLayout(const Layout& layout)
+{
+    iCurrentResX = layout.iResX;
+    iCurrentResY = layout.iResY;
+    fAspectRatio = (float)layout.iResX / (float)layout.iResY;
+    fAspectMultiplier = fAspectRatio / fNativeAspect;
+    fHUDWidth = fAspectRatio < fNativeAspect ? (float)layout.iResX : layout.iResY * fNativeAspect;
+    fHUDHeight = fAspectRatio < fNativeAspect ? (float)layout.iResX / fNativeAspect : (float)layout.iResY;
+    fHUDWidthOffset = (layout.iResX - fHUDWidth) / 2;
+    fHUDHeightOffset = (layout.iResY - fHUDHeight) / 2;
+}
+
+// ns per call, with the same loop resetting the inputs but not calling the handler subtracted. Best of a few runs.
+static double Time(const Case& test, const Layout& layout, size_t iIterations)
+{
+    static Scratch scratch{};
+    SafetyHookContext prepared{};
+    test.prepare(layout, prepared, scratch);
+    Scratch preparedScratch = scratch;
+
+    auto loop = [&](bool bCall) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iIterations; i++) {
+            SafetyHookContext ctx = prepared;
+            memcpy(scratch.memory, preparedScratch.memory, 0x100);
+            asm volatile("" : : "r"(&ctx), "r"(scratch.memory) : "memory");
+            if (bCall)
+                test.handler(ctx);
+            asm volatile("" : : "r"(&ctx), "r"(scratch.memory) : "memory");
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double fBaseline = loop(false);
+    double fTotal = loop(true);
+    for (int iRun = 1; iRun < 5; iRun++) {
+        fBaseline = std::min(fBaseline, loop(false));
+        fTotal = std::min(fTotal, loop(true));
+    }
+    return std::max(0.0, fTotal - fBaseline) / iIterations;
+}
+
+static std::string Adaptive()
+{
+    // Clamped between 1/60 and 1/30, no smoothing
+    struct Step { float fFrametime; float fExpected; };
+    const Step steps[] = { { 1.0f / 45.0f, 1.0f / 45.0f }, { 1.0f / 10.0f, 1.0f / 30.0f }, { 1.0f / 200.0f, 1.0f / 60.0f }, { 0.0f, 1.0f / 60.0f } };
+    for (const Step& step : steps) {
+        std::string sError = CheckValue("step", Handlers::AdaptiveGameSpeedStep(1.0f / 60.0f, step.fFrametime), step.fExpected);
+        if (!sError.empty())
+            return sError;
+    }
+    return {};
+}
+
+int main(int argc, char** argv)
+{
+    size_t iIterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+    if (!iIterations) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    size_t iFailures = 0;
+    printf("%-24s", "ns/call");
+    for (const Layout& layout : layouts)
+        printf(" %8s", layout.sName);
+    printf("\n");
+
+    for (const Case& test : cases) {
+        printf("%-24s", test.sName);
+        std::vector<std::string> errors{};
+        for (const Layout& layout : layouts) {
+            ApplyLayout(layout);
+
+            Scratch scratch{};
+            SafetyHookContext ctx{};
+            test.prepare(layout, ctx, scratch);
+            test.handler(ctx);
+            std::string sError = test.verify(layout, ctx, scratch);
+            if (!sError.empty())
+                errors.push_back(std::string(layout.sName) + ": " + sError);
+
+            printf(" %8.2f", Time(test, layout, iIterations));
+        }
+        printf("\n");
+        for (const std::string& sError : errors)
+            printf("    FAILED %s\n", sError.c_str());
+        iFailures += errors.size();
+    }
+
+    if (std::string sError = Adaptive(); !sError.empty()) {
+        printf("AdaptiveGameSpeedStep    FAILED %s\n", sError.c_str());
+        iFailures++;
+    }
+
+    printf("\n%zu handlers, %zu layouts, %zu failures\n", std::size(cases), std::size(layouts), iFailures);
+    return iFailures ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+// hookreplay - replays a hook capture trace (src/capture.hpp) through the mid-hook handlers.
+//
+// Every record is rebuilt into a SafetyHookContext with the captured registers and globals. The base register of
+// sites that dereference memory is pointed at a local copy of the captured bytes, then the handler runs and its
+// registers and memory are compared with what it produced inside the game. Prints per-site counts, mismatches and
+// time per call, so handler changes can be checked and measured against real inputs without the game.
+// With --selftest it records synthetic inputs through Capture::Run, writes and reloads the trace, and replays it.
+//
+// Build: g++ -std=c++23 -O2 -I external/safetyhook -o hookreplay tools/hookreplay/hookreplay.cpp
+// Usage: hookreplay <trace> [iterations] [max mismatches to print]
+//        hookreplay --selftest [trace] [records per site, at most iMaxRecords / iSiteCount]
+
+#include "../../src/capture.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Owned by dllmain.cpp in the fix
+float fAspectRatio;
+float fNativeAspect = 16.0f / 9.0f;
+float fAspectMultiplier;
+float fHUDWidth;
+float fHUDHeight;
+float fHUDWidthOffset;
+float fHUDHeightOffset;
+float fGameplayFOVMulti = 1.0f;
+float fCurrentFrametime;
+float fFramerateCap = 60.0f;
+float fAdaptiveMinFramerate = 30.0f;
+float fAdaptiveSmoothing = 0.2f;
+int iCurrentResX;
+int iCurrentResY;
+
+struct SiteResult {
+    uint64_t iRecords = 0;
+    uint64_t iSkipped = 0;
+    uint64_t iMismatches = 0;
+    std::chrono::steady_clock::duration time{};
+};
+
+// Stand-ins for the game memory the handlers touch
+struct Scratch {
+    alignas(16) uint8_t memory[Capture::iMaxMemory];
+    uint8_t iControllerTarget1;
+    uint8_t iControllerTarget2;
+};
+
+static bool Prepare(const Capture::Record& record, SafetyHookContext& ctx, Scratch& scratch)
+{
+    const Capture::SiteInfo& site = Capture::sites[record.iSite];
+    if (site.base != Capture::Base::None && record.iMemorySize != site.iSize)
+        return false;
+
+    ctx = {};
+    Capture::WriteRegisters(ctx, record.in);
+    Capture::ApplyGlobals(record.globals);
+    if (site.base != Capture::Base::None) {
+        memcpy(scratch.memory, record.memoryIn, site.iSize);
+        Capture::BaseRegister(ctx, site.base) = reinterpret_cast<uintptr_t>(scratch.memory) - site.iOffset;
+    }
+    Handlers::ControllerInputTarget1 = &scratch.iControllerTarget1;
+    Handlers::ControllerInputTarget2 = &scratch.iControllerTarget2;
+    return true;
+}
+
+static bool Matches(const Capture::Record& record, SafetyHookContext& ctx, const Scratch& scratch)
+{
+    const Capture::SiteInfo& site = Capture::sites[record.iSite];
+    // Put the game's pointer back before comparing
+    if (site.base != Capture::Base::None) {
+        SafetyHookContext in{};
+        Capture::WriteRegisters(in, record.in);
+        uintptr_t& base = Capture::BaseRegister(ctx, site.base);
+        if (base == reinterpret_cast<uintptr_t>(scratch.memory) - site.iOffset)
+            base = Capture::BaseRegister(in, site.base);
+    }
+
+    Capture::Registers out = Capture::ReadRegisters(ctx);
+    if (memcmp(&out, &record.out, sizeof(out)) != 0)
+        return false;
+    return memcmp(scratch.memory, record.memoryOut, record.iMemorySize) == 0;
+}
+
+static void PrintMismatch(const Capture::Record& record, const SafetyHookContext& ctx, const Scratch& scratch)
+{
+    const Capture::SiteInfo& site = Capture::sites[record.iSite];
+    Capture::Registers out = Capture::ReadRegisters(ctx);
+    printf("  %s mismatch at %lld (thread %u)\n", site.sName, (long long)record.iTimestamp, record.iThreadId);
+    for (size_t i = 0; i < 8; i++) {
+        if (memcmp(&out.xmm[i], &record.out.xmm[i], sizeof(float)) != 0)
+            printf("    xmm%zu: replay %.9g, game %.9g (in %.9g)\n", i, out.xmm[i], record.out.xmm[i], record.in.xmm[i]);
+    }
+    if (out.rflags != record.out.rflags)
+        printf("    rflags: replay %#llx, game %#llx\n", (unsigned long long)out.rflags, (unsigned long long)record.out.rflags);
+    for (size_t i = 0; i + sizeof(float) <= record.iMemorySize; i += sizeof(float)) {
+        float fReplay, fGame, fIn;
+        memcpy(&fReplay, scratch.memory + i, sizeof(float));
+        memcpy(&fGame, record.memoryOut + i, sizeof(float));
+        memcpy(&fIn, record.memoryIn + i, sizeof(float));
+        if (memcmp(&fReplay, &fGame, sizeof(float)) != 0)
+            printf("    [base+%#zx]: replay %.9g, game %.9g (in %.9g)\n", site.iOffset + i, fReplay, fGame, fIn);
+    }
+}
+
+static int Replay(const std::vector<Capture::Record>& records, int iIterations, int iMaxPrinted)
+{
+    SiteResult results[Capture::iSiteCount]{};
+    SafetyHookContext ctx{};
+    Scratch scratch{};
+    int iPrinted = 0;
+
+    // Cost of the timing itself, taken off every call
+    auto overheadStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ctx.rflags += std::chrono::steady_clock::now() > start;
+    }
+    double fOverhead = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - overheadStart).count() / 100000.0 / 2.0;
+
+    // First pass checks, the rest only time
+    for (int iIteration = 0; iIteration < iIterations; iIteration++) {
+        for (const Capture::Record& record : records) {
+            if (record.iSite >= Capture::iSiteCount)
+                continue;
+
+            SiteResult& result = results[record.iSite];
+            if (!Prepare(record, ctx, scratch)) {
+                if (iIteration == 0)
+                    result.iSkipped++;
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            Capture::sites[record.iSite].handler(ctx);
+            result.time += std::chrono::steady_clock::now() - start;
+
+            if (iIteration != 0)
+                continue;
+            result.iRecords++;
+            if (!Matches(record, ctx, scratch)) {
+                result.iMismatches++;
+                if (iPrinted++ < iMaxPrinted)
+                    PrintMismatch(record, ctx, scratch);
+            }
+        }
+    }
+
+    uint64_t iTotalMismatches = 0;
+    printf("%-24s %10s %8s %10s %10s\n", "site", "records", "skipped", "mismatch", "ns/call");
+    for (size_t i = 0; i < Capture::iSiteCount; i++) {
+        const SiteResult& result = results[i];
+        if (!result.iRecords && !result.iSkipped)
+            continue;
+        double fNanoseconds = std::chrono::duration<double, std::nano>(result.time).count() / (double)std::max<uint64_t>(1, result.iRecords * iIterations);
+        fNanoseconds = std::max(0.0, fNanoseconds - fOverhead);
+        printf("%-24s %10llu %8llu %10llu %10.1f\n", Capture::sites[i].sName, (unsigned long long)result.iRecords,
+            (unsigned long long)result.iSkipped, (unsigned long long)result.iMismatches, fNanoseconds);
+        iTotalMismatches += result.iMismatches;
+    }
+    return iTotalMismatches ? 1 : 0;
+}
+
+// Fills the buffer through the real capture path with inputs that hit every branch of the handlers
+static void Generate(size_t iPerSite)
+{
+    const int resolutions[][2] = { { 1920, 1080 }, { 2560, 1080 }, { 3440, 1440 }, { 5120, 1440 }, { 1280, 1024 }, { 1920, 1200 }, { 2560, 1600 }, { 800, 600 } };
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> any(-4000.0f, 4000.0f);
+
+    Capture::Start(3600.0, 1000000000);
+    Scratch scratch{};
+    alignas(16) uint8_t stack[0x100]{};
+
+    for (size_t iSite = 0; iSite < Capture::iSiteCount; iSite++) {
+        const Capture::SiteInfo& site = Capture::sites[iSite];
+        for (size_t i = 0; i < iPerSite; i++) {
+            const int* resolution = resolutions[rng() % std::size(resolutions)];
+            iCurrentResX = resolution[0];
+            iCurrentResY = resolution[1];
+            fAspectRatio = (float)iCurrentResX / (float)iCurrentResY;
+            fAspectMultiplier = fAspectRatio / fNativeAspect;
+            fHUDWidth = fAspectRatio < fNativeAspect ? (float)iCurrentResX : iCurrentResY * fNativeAspect;
+            fHUDHeight = fAspectRatio < fNativeAspect ? (float)iCurrentResX / fNativeAspect : (float)iCurrentResY;
+            fHUDWidthOffset = (iCurrentResX - fHUDWidth) / 2;
+            fHUDHeightOffset = (iCurrentResY - fHUDHeight) / 2;
+            fGameplayFOVMulti = 0.5f + (rng() % 100) / 50.0f;
+            fCurrentFrametime = 1.0f / (float)(30 + rng() % 211);
+
+            SafetyHookContext ctx{};
+            safetyhook::Xmm* xmm[8] = { &ctx.xmm0, &ctx.xmm1, &ctx.xmm2, &ctx.xmm3, &ctx.xmm4, &ctx.xmm5, &ctx.xmm6, &ctx.xmm7 };
+            for (safetyhook::Xmm* reg : xmm)
+                reg->f32[0] = any(rng);
+            // Most sites only act on exact UI-space or screen-space sizes
+            bool bScreenSpace = iSite == static_cast<size_t>(Capture::Site::MenuBackgrounds);
+            if (rng() % 4) {
+                ctx.xmm0.f32[0] = bScreenSpace ? (float)iCurrentResX : 1920.0f;
+                ctx.xmm1.f32[0] = bScreenSpace ? (float)iCurrentResY : 1920.0f;
+                ctx.xmm2.f32[0] = 1920.0f;
+            }
+            ctx.rax = rng() % 64;
+            ctx.rflags = 0x202 | (rng() & 1);
+
+            float rect[4] = { 0.0f, 0.0f, 1920.0f, 1080.0f };
+            memcpy(scratch.memory, rect, sizeof(rect));
+            if (site.base != Capture::Base::None)
+                Capture::BaseRegister(ctx, site.base) = reinterpret_cast<uintptr_t>(site.base == Capture::Base::Rsp ? stack : scratch.memory - site.iOffset);
+            if (site.base == Capture::Base::Rsp)
+                memcpy(stack + site.iOffset, rect, sizeof(rect));
+            Handlers::ControllerInputTarget1 = &scratch.iControllerTarget1;
+            Handlers::ControllerInputTarget2 = &scratch.iControllerTarget2;
+
+            Capture::runTable[iSite](ctx);
+        }
+    }
+    Capture::Stop();
+}
+
+static int SelfTest(const std::string& sPath, size_t iPerSite)
+{
+    Capture::bActive = true;
+    Generate(iPerSite);
+    if (Capture::DroppedRecords() || Capture::RecordCount() != iPerSite * Capture::iSiteCount) {
+        fprintf(stderr, "expected %zu records, captured %zu (%zu dropped)\n", iPerSite * Capture::iSiteCount, Capture::RecordCount(), Capture::DroppedRecords());
+        return 1;
+    }
+    if (!Capture::Write(sPath)) {
+        fprintf(stderr, "failed to write %s\n", sPath.c_str());
+        return 1;
+    }
+
+    Capture::TraceHeader header{};
+    std::vector<Capture::Record> loaded{};
+    std::string sError = Capture::Load(sPath, header, loaded);
+    remove(sPath.c_str());
+    if (!sError.empty()) {
+        fprintf(stderr, "%s\n", sError.c_str());
+        return 1;
+    }
+
+    printf("self test: %zu records, %zu bytes each\n", loaded.size(), sizeof(Capture::Record));
+    return Replay(loaded, 100, 10);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--selftest") == 0) {
+        // Every site has to fit in the capture buffer, anything past it would be dropped
+        constexpr size_t iMaxPerSite = Capture::iMaxRecords / Capture::iSiteCount;
+        size_t iPerSite = argc > 3 ? strtoull(argv[3], nullptr, 10) : iMaxPerSite;
+        if (iPerSite == 0 || iPerSite > iMaxPerSite) {
+            fprintf(stderr, "records per site must be between 1 and %zu\n", iMaxPerSite);
+            return 2;
+        }
+        return SelfTest(argc > 2 ? argv[2] : "hookreplay_selftest.bin", iPerSite);
+    }
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: hookreplay <trace> [iterations] [max mismatches to print]\n       hookreplay --selftest [trace] [records per site]\n");
+        return 2;
+    }
+
+    Capture::TraceHeader header{};
+    std::vector<Capture::Record> records{};
+    std::string sError = Capture::Load(argv[1], header, records);
+    if (!sError.empty()) {
+        fprintf(stderr, "%s: %s\n", argv[1], sError.c_str());
+        return 1;
+    }
+
+    if (!records.empty()) {
+        double fSeconds = (double)(records.back().iTimestamp - records.front().iTimestamp) / (double)header.iFrequency;
+        printf("%s: %llu records over %.2f s\n", argv[1], (unsigned long long)header.iRecordCount, fSeconds);
+    }
+    return Replay(records, argc > 2 ? std::max(1, atoi(argv[2])) : 10, argc > 3 ? atoi(argv[3]) : 20);
+}
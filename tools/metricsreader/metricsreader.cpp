@@ -0,0 +1,136 @@
+// metricsreader - reads the shared-memory metrics block published by the fix (src/metrics.hpp).
+//
+// Prints one line per sample from the running game. With --simulate it instead creates the block itself and runs a
+// writer thread that publishes frames as fast as it can with fields that depend on each other, while the reader
+// checks every snapshot for torn reads. On Linux the mapping is a POSIX shared-memory object, so the seqlock and
+// layout can be tested without the game.
+//
+// Build (Linux):   g++ -std=c++20 -O2 -pthread -o metricsreader tools/metricsreader/metricsreader.cpp
+// Build (Windows): cl /std:c++20 /O2 /EHsc tools\metricsreader\metricsreader.cpp
+// Usage: metricsreader [interval ms] [samples, 0 = forever]
+//        metricsreader --simulate [seconds]
+
+#include "../../src/metrics.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static int Simulate(double fSeconds)
+{
+#ifndef _WIN32
+    shm_unlink(Metrics::sMappingName);
+#endif
+    if (!Metrics::Create(0, 1000000000)) {
+        fprintf(stderr, "failed to create the metrics mapping\n");
+        return 1;
+    }
+
+    std::atomic<bool> bRunning = true;
+    std::thread writer([&]() {
+        Metrics::Payload payload{};
+        while (bRunning.load(std::memory_order_relaxed)) {
+            payload.iFrame++;
+            payload.iTimestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            payload.fFrameTime = static_cast<float>(payload.iFrame % 1000);
+            payload.iResX = static_cast<int32_t>(payload.iFrame % 7680);
+            payload.iResY = payload.iResX / 2;
+            payload.iHeapAllocations = payload.iFrame * 3;
+            payload.iFileCacheBytes = ~payload.iFrame;
+            Metrics::Publish(payload);
+        }
+    });
+
+    const Metrics::Block* block = Metrics::Open();
+    if (!block) {
+        fprintf(stderr, "failed to open the metrics mapping\n");
+        bRunning = false;
+        writer.join();
+        return 1;
+    }
+
+    uint64_t iReads = 0;
+    uint64_t iFailed = 0;
+    uint64_t iTorn = 0;
+    uint64_t iBackwards = 0;
+    uint64_t iLastFrame = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(fSeconds);
+    while (std::chrono::steady_clock::now() < end) {
+        Metrics::Payload payload{};
+        if (!Metrics::Read(block, payload)) {
+            iFailed++;
+            continue;
+        }
+
+        // Nothing published yet
+        if (payload.iFrame == 0)
+            continue;
+
+        iReads++;
+        if (payload.fFrameTime != static_cast<float>(payload.iFrame % 1000) || payload.iResX != static_cast<int32_t>(payload.iFrame % 7680)
+            || payload.iResY != payload.iResX / 2 || payload.iHeapAllocations != payload.iFrame * 3 || payload.iFileCacheBytes != ~payload.iFrame)
+            iTorn++;
+        if (payload.iFrame < iLastFrame)
+            iBackwards++;
+        iLastFrame = payload.iFrame;
+    }
+
+    bRunning = false;
+    writer.join();
+    Metrics::Close(block);
+#ifndef _WIN32
+    shm_unlink(Metrics::sMappingName);
+#endif
+
+    printf("frames written %llu, snapshots %llu, busy %llu, torn %llu, out of order %llu\n",
+        (unsigned long long)iLastFrame, (unsigned long long)iReads, (unsigned long long)iFailed, (unsigned long long)iTorn, (unsigned long long)iBackwards);
+    return iTorn || iBackwards ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--simulate") == 0)
+        return Simulate(argc > 2 ? atof(argv[2]) : 5.0);
+
+    int iInterval = argc > 1 ? atoi(argv[1]) : 500;
+    int iSamples = argc > 2 ? atoi(argv[2]) : 0;
+
+    const Metrics::Block* block = Metrics::Open();
+    if (!block) {
+        fprintf(stderr, "no metrics mapping found, is the game running with [Metrics] enabled?\n");
+        return 1;
+    }
+
+    printf("BerserkFix metrics v%u, pid %u, %u bytes\n", block->header.iVersion, block->header.iProcessId, block->header.iBlockSize);
+    printf("%10s %9s %9s %7s %7s %11s %7s %9s %11s %11s\n", "frame", "frame ms", "game ms", "cap", "step", "resolution", "shadow", "gated", "heap MB", "files MB");
+
+    uint64_t iLastFrame = 0;
+    int64_t iLastTimestamp = 0;
+    for (int i = 0; iSamples == 0 || i < iSamples; i++) {
+        Metrics::Payload payload{};
+        if (Metrics::Read(block, payload)) {
+            // Average over the interval as well as the last frame
+            double fAverage = 0.0;
+            if (iLastFrame && payload.iFrame > iLastFrame)
+                fAverage = 1000.0 * (double)(payload.iTimestamp - iLastTimestamp) / (double)block->header.iFrequency / (double)(payload.iFrame - iLastFrame);
+            iLastFrame = payload.iFrame;
+            iLastTimestamp = payload.iTimestamp;
+
+            char sResolution[32];
+            snprintf(sResolution, sizeof(sResolution), "%dx%d", payload.iResX, payload.iResY);
+            printf("%10llu %9.3f %9.3f %7.1f %7.4f %11s %7d %9u %11.1f %11.1f  avg %.3f ms\n", (unsigned long long)payload.iFrame,
+                payload.fFrameTime, payload.fGameFrametime * 1000.0f, payload.fFramerateCap, payload.fGameSpeedStep, sResolution,
+                payload.iShadowResolution, payload.iGatedHooks, payload.iHeapCommittedBytes / 1048576.0, payload.iFileCacheBytes / 1048576.0, fAverage);
+        }
+        else {
+            printf("busy\n");
+        }
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(iInterval));
+    }
+
+    Metrics::Close(block);
+    return 0;
+}
@@ -0,0 +1,184 @@
+// patchbake - bakes the fix's static byte patches into a copy of the game executable.
+//
+// Scans the executable with the same signatures the fix uses (src/signatures.hpp), applies the patches that never
+// change at runtime to a copy of the file and writes BerserkFix.patches (src/prepatch.hpp) describing them:
+//   Resolution   ResCheck jump, 800x450 list entry -> custom resolution, startup resolution index, window mode
+//                (--windowed for Windowed or Borderless)
+//   HUD          HUD offset codepath jump
+// With the patched executable and manifest in place the fix skips those scans and writes at startup. Data patches
+// are only baked when the value has initialised bytes in the file. The values must match BerserkFix.ini, otherwise
+// the fix falls back to patching at runtime.
+//
+// Build: g++ -std=c++20 -O2 -o patchbake tools/patchbake/patchbake.cpp
+// Usage: patchbake <BERSERK.exe> <patched.exe> --res <width>x<height> [--windowed] [--skip <Resolution|HUD>]
+//                  [--manifest <BerserkFix.patches>]
+//
+// Exit code is 0 when every requested patch was baked, 1 when any was skipped, 2 on errors.
+
+#include "../../src/signatures.hpp"
+#include "../../src/prepatch.hpp"
+#include "../common/peimage.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+
+struct Baker {
+    PE::Image image{};
+    std::vector<uint8_t> file{};
+    PrePatch::Manifest manifest{};
+    bool bSkipped = false;
+
+    // RVA of the only match, 0 when missing or ambiguous
+    uint32_t Find(const Signatures::Signature& signature)
+    {
+        auto pattern = Signatures::ParsePattern(signature.sPattern);
+        const uint8_t* data = image.Base();
+        size_t iSize = image.data.size();
+        size_t iMatches = 0;
+        uint32_t iRva = 0;
+        for (size_t i = 0; i + pattern.size() < iSize; i++) {
+            if (Signatures::Matches(data + i, iSize - i, pattern) && iMatches++ == 0)
+                iRva = static_cast<uint32_t>(i);
+        }
+
+        if (iMatches != 1) {
+            printf("%-20s %s, not baked\n", signature.sName, iMatches ? "ambiguous" : "not found");
+            bSkipped = true;
+            return 0;
+        }
+        return iRva;
+    }
+
+    uint32_t Resolve(const Signatures::Signature& signature)
+    {
+        uint32_t iRva = Find(signature);
+        if (!iRva)
+            return 0;
+
+        int64_t iTarget = (int64_t)iRva + Signatures::AbsoluteOffset(image.Base() + iRva, signature);
+        if (iTarget <= 0 || iTarget >= (int64_t)image.iImageSize) {
+            printf("%-20s resolves outside the image, not baked\n", signature.sName);
+            bSkipped = true;
+            return 0;
+        }
+        return static_cast<uint32_t>(iTarget);
+    }
+
+    void Apply(const char* sName, const char* sFeature, uint32_t iRva, const std::vector<uint8_t>& patched)
+    {
+        if (!iRva)
+            return;
+
+        size_t iOffset = PE::FileOffset(image, iRva, patched.size());
+        if (!iOffset || iOffset + patched.size() > file.size()) {
+            printf("%-20s RVA 0x%x has no initialised bytes in the file, not baked\n", sName, iRva);
+            bSkipped = true;
+            return;
+        }
+
+        PrePatch::Patch patch{ sName, sFeature, iRva };
+        patch.original.assign(file.begin() + iOffset, file.begin() + iOffset + patched.size());
+        patch.patched = patched;
+        memcpy(file.data() + iOffset, patched.data(), patched.size());
+        printf("%-20s RVA 0x%-8x file 0x%-8zx %s -> %s\n", sName, iRva, iOffset, PrePatch::ToHex(patch.original).c_str(), PrePatch::ToHex(patch.patched).c_str());
+        manifest.patches.push_back(std::move(patch));
+    }
+};
+
+int main(int argc, char** argv)
+{
+    std::string sExePath;
+    std::string sOutputPath;
+    std::string sManifestPath = "BerserkFix.patches";
+    std::set<std::string> skipped{};
+    int iResX = 0;
+    int iResY = 0;
+    bool bWindowed = false;
+    for (int i = 1; i < argc; i++) {
+        std::string sArg = argv[i];
+        if (sArg == "--res" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &iResX, &iResY) != 2)
+                iResX = iResY = 0;
+        }
+        else if (sArg == "--windowed")
+            bWindowed = true;
+        else if (sArg == "--skip" && i + 1 < argc)
+            skipped.insert(argv[++i]);
+        else if (sArg == "--manifest" && i + 1 < argc)
+            sManifestPath = argv[++i];
+        else if (sExePath.empty())
+            sExePath = sArg;
+        else if (sOutputPath.empty())
+            sOutputPath = sArg;
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    bool bResolution = !skipped.count("Resolution");
+    bool bHUD = !skipped.count("HUD");
+    if (sExePath.empty() || sOutputPath.empty() || (bResolution && (iResX <= 0 || iResY <= 0 || iResX > 0x7FFF || iResY > 0x7FFF))) {
+        fprintf(stderr, "Usage: %s <BERSERK.exe> <patched.exe> --res <width>x<height> [--windowed] [--skip <Resolution|HUD>] [--manifest <path>]\n", argv[0]);
+        return 2;
+    }
+    if (sExePath == sOutputPath) {
+        fprintf(stderr, "Refusing to patch %s in place, keep the original for updates and verification.\n", sExePath.c_str());
+        return 2;
+    }
+
+    Baker baker{};
+    if (std::string sError = PE::Load(sExePath, baker.image); !sError.empty()) {
+        fprintf(stderr, "%s: %s\n", sExePath.c_str(), sError.c_str());
+        return 2;
+    }
+    std::ifstream input(sExePath, std::ios::binary);
+    baker.file.assign((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    baker.manifest = { baker.image.iTimestamp, baker.image.iImageSize };
+
+    printf("%s: timestamp 0x%08x, image size 0x%x\n\n", sExePath.c_str(), baker.image.iTimestamp, baker.image.iImageSize);
+
+    if (bResolution) {
+        uint32_t iResCheck = baker.Find(Signatures::ResCheck);
+        baker.Apply("ResCheck", "Resolution", iResCheck, { std::begin(PrePatch::JumpShort), std::end(PrePatch::JumpShort) });
+
+        uint32_t iResList = baker.Resolve(Signatures::ResolutionList);
+        baker.Apply("ResolutionList", "Resolution", iResList ? iResList + PrePatch::iResolutionEntryOffset : 0, PrePatch::ResolutionEntry(iResX, iResY));
+
+        uint32_t iResIndex = baker.Resolve(Signatures::ResolutionIndex);
+        baker.Apply("ResolutionIndex", "Resolution", iResIndex, PrePatch::Bytes(PrePatch::iForcedResolutionIndex));
+
+        uint32_t iWindowMode = baker.Resolve(Signatures::WindowMode);
+        baker.Apply("WindowMode", "Resolution", iWindowMode, PrePatch::Bytes((int)bWindowed));
+    }
+
+    if (bHUD) {
+        uint32_t iHUDOffsetCodepath = baker.Find(Signatures::HUDOffsetCodepath);
+        baker.Apply("HUDOffsetCodepath", "HUD", iHUDOffsetCodepath, { std::begin(PrePatch::JumpShort), std::end(PrePatch::JumpShort) });
+    }
+
+    if (baker.manifest.patches.empty()) {
+        fprintf(stderr, "\nNothing to bake.\n");
+        return 2;
+    }
+
+    std::ofstream output(sOutputPath, std::ios::binary | std::ios::trunc);
+    if (!output || !output.write(reinterpret_cast<const char*>(baker.file.data()), baker.file.size())) {
+        fprintf(stderr, "Could not write %s\n", sOutputPath.c_str());
+        return 2;
+    }
+
+    std::ofstream manifestFile(sManifestPath, std::ios::trunc);
+    if (!manifestFile) {
+        fprintf(stderr, "Could not write %s\n", sManifestPath.c_str());
+        return 2;
+    }
+    PrePatch::Write(manifestFile, baker.manifest);
+
+    printf("\nWrote %s and %s (%zu patches)\n", sOutputPath.c_str(), sManifestPath.c_str(), baker.manifest.patches.size());
+    if (bResolution)
+        printf("[Custom Resolution] in BerserkFix.ini must be %dx%d and %s to match.\n", iResX, iResY, bWindowed ? "Windowed or Borderless" : "neither Windowed nor Borderless");
+    return baker.bSkipped ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+// schedcheck - checks the thread classification and placement logic in src/scheduler.hpp.
+//
+// Runs Classify, AffinityMask and Untracked against simulated thread lists and CPU topologies: a hybrid 8P+16E part
+// with SMT on the P-cores, a non-hybrid 8-core part and a process affinity mask that excludes some cores. Threads
+// exit, new ones reuse their IDs and the main thread is found by creation time regardless of enumeration order.
+// Prints every failed case and exits non-zero if there were any.
+//
+// Build: g++ -std=c++20 -O2 -o schedcheck tools/schedcheck/schedcheck.cpp
+// Usage: schedcheck
+
+#include "../../src/scheduler.hpp"
+
+#include <cstdio>
+
+static int iFailures = 0;
+
+static void Check(bool bOk, const char* sCase)
+{
+    if (!bOk) {
+        fprintf(stderr, "FAIL: %s\n", sCase);
+        iFailures++;
+    }
+}
+
+static constexpr uintptr_t iModuleBase = 0x140000000;
+static constexpr size_t iModuleSize = 0x2000000;
+static constexpr uintptr_t iRenderThreadRVA = 0x51230;
+
+static void CheckClassify()
+{
+    // Enumeration order doesn't follow creation order, the oldest in-image thread is the main thread
+    std::vector<Scheduler::ThreadInfo> threads = {
+        { 1200, iModuleBase + 0x8000, 300 },            // Worker
+        { 1100, 0x7FF800001000, 50 },                   // System thread, older than everything in the image
+        { 1000, iModuleBase + 0x1000, 100 },            // Main
+        { 1300, iModuleBase + iRenderThreadRVA, 200 },  // Render
+        { 1400, iModuleBase + iModuleSize, 400 },       // One past the end of the image
+        { 1500, iModuleBase - 1, 500 },                 // One before the image
+        { 1600, iModuleBase + 0x8000, 600 },            // Worker, same entry point as 1200
+    };
+    auto classes = Scheduler::Classify(threads, iModuleBase, iModuleSize, iRenderThreadRVA);
+    using enum Scheduler::ThreadClass;
+    Check(classes == std::vector{ Worker, Other, Main, Render, Other, Other, Worker }, "classify: mixed thread list");
+
+    // Without a render RVA the render thread is just another worker
+    auto noRender = Scheduler::Classify(threads, iModuleBase, iModuleSize, 0);
+    Check(noRender == std::vector{ Worker, Other, Main, Worker, Other, Other, Worker }, "classify: no render RVA");
+
+    std::vector<Scheduler::ThreadInfo> renderOldest = { { 1, iModuleBase + iRenderThreadRVA, 10 }, { 2, iModuleBase + 0x10, 20 } };
+    Check(Scheduler::Classify(renderOldest, iModuleBase, iModuleSize, iRenderThreadRVA) == std::vector{ Render, Main }, "classify: render thread older than main");
+
+    Check(Scheduler::Classify({}, iModuleBase, iModuleSize, iRenderThreadRVA).empty(), "classify: empty thread list");
+
+    std::vector<Scheduler::ThreadInfo> foreign = { { 1, 0x1000, 10 }, { 2, 0x7FF800000000, 20 } };
+    Check(Scheduler::Classify(foreign, iModuleBase, iModuleSize, iRenderThreadRVA) == std::vector{ Other, Other }, "classify: no thread in the image");
+}
+
+static void CheckAffinity()
+{
+    using Scheduler::Affinity;
+
+    // 8 P-cores with SMT (logical 0-15) and 16 E-cores (logical 16-31)
+    Scheduler::Topology hybrid{ 0x0000FFFF, 0xFFFF0000 };
+    Check(Scheduler::AffinityMask(Affinity::PCores, hybrid, 0xFFFFFFFF) == 0x0000FFFF, "affinity: hybrid P-cores");
+    Check(Scheduler::AffinityMask(Affinity::ECores, hybrid, 0xFFFFFFFF) == 0xFFFF0000, "affinity: hybrid E-cores");
+    Check(Scheduler::AffinityMask(Affinity::All, hybrid, 0xFFFFFFFF) == 0, "affinity: All doesn't restrict");
+
+    // The process mask always wins, and a core class the process may not use at all leaves affinity alone
+    Check(Scheduler::AffinityMask(Affinity::PCores, hybrid, 0x00FF00F0) == 0x000000F0, "affinity: restricted process mask");
+    Check(Scheduler::AffinityMask(Affinity::ECores, hybrid, 0x0000FFFF) == 0, "affinity: no allowed E-cores");
+
+    // Non-hybrid 8 cores with SMT, every core is in the performance class
+    Scheduler::Topology uniform{ 0xFFFF, 0 };
+    Check(Scheduler::AffinityMask(Affinity::PCores, uniform, 0xFFFF) == 0xFFFF, "affinity: non-hybrid P-cores");
+    Check(Scheduler::AffinityMask(Affinity::ECores, uniform, 0xFFFF) == 0, "affinity: non-hybrid E-cores");
+
+    // QueryTopology failed
+    Check(Scheduler::AffinityMask(Affinity::PCores, {}, 0xFFFF) == 0, "affinity: unknown topology");
+}
+
+static void CheckTracking()
+{
+    std::set<Scheduler::ThreadKey> applied{};
+    auto pass = [&](const std::vector<Scheduler::ThreadInfo>& threads) {
+        auto classes = Scheduler::Classify(threads, iModuleBase, iModuleSize, iRenderThreadRVA);
+        std::vector<uint32_t> ids{};
+        for (size_t i : Scheduler::Untracked(threads, classes, applied))
+            ids.push_back(threads[i].iThreadId);
+        return ids;
+    };
+
+    std::vector<Scheduler::ThreadInfo> threads = {
+        { 1000, iModuleBase + 0x1000, 100 },
+        { 1100, 0x7FF800001000, 50 },
+        { 1200, iModuleBase + 0x8000, 300 },
+    };
+    Check(pass(threads) == std::vector<uint32_t>{ 1000, 1200 }, "tracking: first pass applies every game thread");
+    Check(pass(threads).empty(), "tracking: second pass applies nothing");
+    Check(applied.size() == 2, "tracking: applied holds the live game threads");
+
+    // 1200 exits, a new worker gets its ID and a new render thread starts
+    threads[2] = { 1200, iModuleBase + 0x9000, 700 };
+    threads.push_back({ 1300, iModuleBase + iRenderThreadRVA, 800 });
+    Check(pass(threads) == std::vector<uint32_t>{ 1200, 1300 }, "tracking: reused thread ID is applied again");
+    Check(applied.size() == 3 && !applied.contains({ 1200, 300 }), "tracking: exited thread is dropped");
+
+    // Everything but the main thread exits
+    threads.resize(1);
+    Check(pass(threads).empty(), "tracking: nothing new after exits");
+    Check(applied.size() == 1 && applied.contains({ 1000, 100 }), "tracking: applied shrinks with the thread list");
+
+    // Thousands of short-lived workers never accumulate
+    for (uint32_t i = 0; i < 10000; i++) {
+        std::vector<Scheduler::ThreadInfo> churn = { threads[0], { 2000 + (i % 4) * 4, iModuleBase + 0x8000, 1000 + i } };
+        Check(pass(churn) == std::vector<uint32_t>{ 2000 + (i % 4) * 4 }, "tracking: short-lived worker is applied");
+    }
+    Check(applied.size() == 2, "tracking: applied stays bounded under thread churn");
+}
+
+int main()
+{
+    CheckClassify();
+    CheckAffinity();
+    CheckTracking();
+
+    if (iFailures) {
+        fprintf(stderr, "%d failures\n", iFailures);
+        return 1;
+    }
+    printf("schedcheck: ok\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+// sigcheck - dry-run the fix's signature set against a game executable without launching the game.
+//
+// Maps the executable with its in-memory section layout, runs every signature from src/signatures.hpp the same
+// way Memory::PatternScan() does and reports match counts, RVAs, GetAbsolute() derivations and scan time.
+// Can also write BerserkFix.cache ahead of time so the fix starts with a warm scan cache.
+//
+// Build: g++ -std=c++20 -O2 -o sigcheck tools/sigcheck/sigcheck.cpp
+// Usage: sigcheck <BERSERK.exe> [--feature <Resolution|AspectFOV|HUD|Framerate|Misc>] [--cache <BerserkFix.cache>]
+//
+// Exit code is 0 when every signature matched exactly once, 1 when any signature is missing or ambiguous.
+
+#include "../../src/signatures.hpp"
+#include "../../src/scancache.hpp"
+#include "../common/peimage.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+struct Result {
+    const Signatures::Signature* signature;
+    size_t iMatches = 0;
+    uint32_t iFirstRva = 0;
+    double fFirstMatchMs = 0.0;     // What the fix pays at runtime, it stops at the first match
+    double fFullScanMs = 0.0;
+};
+
+static Result Scan(const PE::Image& image, const Signatures::Signature& signature)
+{
+    Result result{ &signature };
+    auto pattern = Signatures::ParsePattern(signature.sPattern);
+    const uint8_t* data = image.Base();
+    size_t iSize = image.data.size();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + pattern.size() < iSize; i++) {
+        if (!Signatures::Matches(data + i, iSize - i, pattern))
+            continue;
+
+        if (result.iMatches++ == 0) {
+            result.iFirstRva = static_cast<uint32_t>(i);
+            result.fFirstMatchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    result.fFullScanMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (result.iMatches == 0)
+        result.fFirstMatchMs = result.fFullScanMs;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    std::string sExePath;
+    std::string sFeature;
+    std::string sCachePath;
+    for (int i = 1; i < argc; i++) {
+        std::string sArg = argv[i];
+        if (sArg == "--feature" && i + 1 < argc)
+            sFeature = argv[++i];
+        else if (sArg == "--cache" && i + 1 < argc)
+            sCachePath = argv[++i];
+        else if (sExePath.empty())
+            sExePath = sArg;
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (sExePath.empty()) {
+        fprintf(stderr, "Usage: %s <BERSERK.exe> [--feature <name>] [--cache <BerserkFix.cache>]\n", argv[0]);
+        return 2;
+    }
+
+    PE::Image image{};
+    if (std::string sError = PE::Load(sExePath, image); !sError.empty()) {
+        fprintf(stderr, "%s: %s\n", sExePath.c_str(), sError.c_str());
+        return 2;
+    }
+
+    printf("%s: timestamp 0x%08x, image size 0x%x, image base 0x%llx\n\n", sExePath.c_str(), image.iTimestamp, image.iImageSize, (unsigned long long)image.iImageBase);
+    printf("%-12s %-28s %7s %10s %10s %10s  %s\n", "Feature", "Signature", "Matches", "RVA", "First ms", "Full ms", "Derived");
+
+    ScanCache::Cache cache{ image.iTimestamp, image.iImageSize };
+    bool bFailed = false;
+    double fTotalMs = 0.0;
+    for (const Signatures::Signature* signature : Signatures::All) {
+        if (!sFeature.empty() && sFeature != signature->sFeature)
+            continue;
+
+        Result result = Scan(image, *signature);
+        fTotalMs += result.fFirstMatchMs;
+
+        std::string sDerived;
+        if (result.iMatches && signature->bAbsolute) {
+            int64_t iTarget = (int64_t)result.iFirstRva + Signatures::AbsoluteOffset(image.Base() + result.iFirstRva, *signature);
+            char sBuffer[96];
+            snprintf(sBuffer, sizeof(sBuffer), "GetAbsolute(+%d) -> RVA 0x%llx (0x%llx)%s", signature->iAbsoluteOffset,
+                (unsigned long long)iTarget, (unsigned long long)(image.iImageBase + iTarget),
+                iTarget < 0 || iTarget >= (int64_t)image.iImageSize ? " outside image" : "");
+            sDerived = sBuffer;
+        }
+        if (result.iMatches > 1)
+            sDerived += sDerived.empty() ? "AMBIGUOUS, fix uses the first match" : ", AMBIGUOUS";
+        else if (result.iMatches == 0)
+            sDerived = "NOT FOUND";
+
+        if (result.iMatches)
+            printf("%-12s %-28s %7zu %#10x %10.2f %10.2f  %s\n", signature->sFeature, signature->sName, result.iMatches, result.iFirstRva, result.fFirstMatchMs, result.fFullScanMs, sDerived.c_str());
+        else
+            printf("%-12s %-28s %7zu %10s %10.2f %10.2f  %s\n", signature->sFeature, signature->sName, result.iMatches, "-", result.fFirstMatchMs, result.fFullScanMs, sDerived.c_str());
+
+        if (result.iMatches)
+            cache.results[signature->sName] = result.iFirstRva;
+        if (result.iMatches != 1)
+            bFailed = true;
+    }
+
+    printf("\nTotal scan time (first match, as at runtime): %.2f ms\n", fTotalMs);
+
+    if (!sCachePath.empty()) {
+        std::ofstream cacheFile(sCachePath, std::ios::trunc);
+        if (!cacheFile) {
+            fprintf(stderr, "Could not write %s\n", sCachePath.c_str());
+            return 2;
+        }
+        ScanCache::Write(cacheFile, cache);
+        printf("Wrote %zu results to %s\n", cache.results.size(), sCachePath.c_str());
+    }
+
+    return bFailed ? 1 : 0;
+}
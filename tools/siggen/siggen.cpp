@@ -0,0 +1,407 @@
+// siggen - generates the shortest unique signature for a hook site in a known build of the game.
+//
+// Decodes the instructions at the hook and wildcards every byte that moves between builds: RIP-relative and other
+// displacements, relative branch targets, relocated bytes and immediates that hold image addresses. Then it grows
+// a pattern from the hook and from each instruction boundary shortly after it until exactly one position in the
+// image matches, and keeps the shortest, breaking ties with the estimated Memory::PatternScan() cost. That cost is
+// the average number of byte compares per scanned position, computed from the image's byte frequencies, so patterns
+// that open with rare bytes rank ahead of ones that open with 48/8B/0F.
+// With --all every signature in src/signatures.hpp is regenerated at its current match and compared to the original.
+// Those only start at the match itself, because dllmain.cpp hooks at fixed offsets from it (ScanResult + 0x..).
+// --allow-shift lets them start later too and prints how far each site's hook offsets have to move.
+//
+// Build: gcc -O2 -c -I external/safetyhook external/safetyhook/Zydis.c -o Zydis.o
+//        g++ -std=c++20 -O2 -I external/safetyhook -o siggen tools/siggen/siggen.cpp Zydis.o
+// Usage: siggen <BERSERK.exe> <hook RVA> [--name <name>] [--feature <feature>] [--window <bytes>] [--min <bytes>] [--max <bytes>] [--strict]
+//        siggen <BERSERK.exe> --all [--allow-shift] [--window <bytes>] [--min <bytes>] [--max <bytes>] [--strict]
+//
+// --min (default 8) pads unique patterns that would be too short to survive a patch, --max (default 64) gives up.
+// --strict also wildcards 8-bit displacements and every immediate, for sites in code that changes often.
+// Exit code is 0 when every site got a unique signature, 1 when any did not, 2 on errors.
+
+#include "../../src/signatures.hpp"
+#include "../common/peimage.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <Zydis.h>
+
+struct Options {
+    size_t iWindow = 32;        // How far past the hook a signature may start
+    size_t iMinLength = 8;      // Anything shorter turns ambiguous with the next code change
+    size_t iMaxLength = 64;
+    bool bStrict = false;
+    bool bAllowShift = false;   // --all only, single sites always search the window
+};
+
+struct Candidate {
+    uint32_t iStart = 0;        // RVA the signature matches at
+    std::vector<int> pattern{};
+    double fCost = 0.0;
+};
+
+class Generator {
+public:
+    Generator(const PE::Image& image, const Options& options) : m_image(image), m_options(options)
+    {
+        ZydisDecoderInit(&m_decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+
+        // PatternScan() walks the whole image, so that's what the byte frequencies come from
+        size_t counts[256] = {};
+        for (uint8_t iByte : image.data)
+            counts[iByte]++;
+        for (int i = 0; i < 256; i++)
+            m_frequency[i] = image.data.empty() ? 0.0 : (double)counts[i] / image.data.size();
+
+        LoadRelocations();
+    }
+
+    // Average byte compares per scanned position, the loop in PatternScan() compares until the first mismatch
+    double Cost(const std::vector<int>& pattern) const
+    {
+        double fCost = 0.0;
+        double fReached = 1.0;
+        for (int iByte : pattern) {
+            fCost += fReached;
+            if (iByte != -1)
+                fReached *= m_frequency[iByte];
+        }
+        return fCost;
+    }
+
+    size_t CountMatches(const std::vector<int>& pattern, uint32_t* firstRva = nullptr) const
+    {
+        const uint8_t* data = m_image.Base();
+        size_t iSize = m_image.data.size();
+        size_t iMatches = 0;
+        for (size_t i = 0; i + pattern.size() < iSize; i++) {
+            if (Signatures::Matches(data + i, iSize - i, pattern) && iMatches++ == 0 && firstRva)
+                *firstRva = static_cast<uint32_t>(i);
+        }
+        return iMatches;
+    }
+
+    // Shortest unique signature starting at iHook or, with bShift, an instruction boundary within the window after it
+    bool Generate(uint32_t iHook, Candidate& best, bool bShift = true) const
+    {
+        std::vector<uint32_t> starts{};
+        std::vector<int> masked = Mask(iHook, m_options.iWindow + m_options.iMaxLength, starts);
+
+        bool bFound = false;
+        size_t iBestUnique = 0;
+        bool bBestPadded = false;
+        for (uint32_t iStart : starts) {
+            size_t iOffset = iStart - iHook;
+            if (iOffset > (bShift ? m_options.iWindow : 0))
+                break;
+
+            std::vector<int> window(masked.begin() + iOffset, masked.begin() + std::min(masked.size(), iOffset + m_options.iMaxLength));
+            size_t iUnique = UniqueLength(iStart, window);
+            if (!iUnique)
+                continue;
+
+            size_t iLength = std::max(iUnique, std::min(m_options.iMinLength, window.size()));
+            while (iLength > iUnique && window[iLength - 1] == -1)
+                iLength--;
+            bool bPadded = iLength >= m_options.iMinLength;
+
+            // Ranked on the length that made it unique, padding to --min would otherwise tie most candidates.
+            // Starts too close to the end of the function to reach --min only win when nothing else does.
+            Candidate candidate{ iStart, std::vector<int>(window.begin(), window.begin() + iLength) };
+            candidate.fCost = Cost(candidate.pattern);
+            bool bBetter = !bFound || (bPadded && !bBestPadded);
+            if (bFound && bPadded == bBestPadded)
+                bBetter = iUnique < iBestUnique || (iUnique == iBestUnique && candidate.fCost < best.fCost);
+            if (bBetter) {
+                best = std::move(candidate);
+                iBestUnique = iUnique;
+                bBestPadded = bPadded;
+                bFound = true;
+            }
+        }
+        return bFound;
+    }
+
+private:
+    const PE::Image& m_image;
+    Options m_options;
+    ZydisDecoder m_decoder{};
+    double m_frequency[256] = {};
+    std::vector<bool> m_relocated{};
+
+    // Base relocation directory, every byte the loader rewrites when the image isn't at its preferred base
+    void LoadRelocations()
+    {
+        const std::vector<uint8_t>& data = m_image.data;
+        m_relocated.assign(data.size(), false);
+
+        uint32_t iOptionalHeader = PE::Read<uint32_t>(data, 0x3C) + 24;
+        uint32_t iDirectory = PE::Read<uint32_t>(data, iOptionalHeader + 112 + 5 * 8);
+        uint32_t iDirectorySize = PE::Read<uint32_t>(data, iOptionalHeader + 112 + 5 * 8 + 4);
+        if (!iDirectory || (uint64_t)iDirectory + iDirectorySize > data.size())
+            return;
+
+        for (uint32_t iBlock = iDirectory; iBlock + 8 <= iDirectory + iDirectorySize;) {
+            uint32_t iPage = PE::Read<uint32_t>(data, iBlock);
+            uint32_t iBlockSize = PE::Read<uint32_t>(data, iBlock + 4);
+            if (iBlockSize < 8)
+                break;
+
+            for (uint32_t iEntry = iBlock + 8; iEntry + 2 <= iBlock + iBlockSize; iEntry += 2) {
+                uint16_t iValue = PE::Read<uint16_t>(data, iEntry);
+                size_t iSize = (iValue >> 12) == 10 ? 8 : (iValue >> 12) == 3 ? 4 : 0;     // DIR64, HIGHLOW
+                size_t iRva = iPage + (iValue & 0xFFF);
+                for (size_t i = 0; i < iSize && iRva + i < data.size(); i++)
+                    m_relocated[iRva + i] = true;
+            }
+            iBlock += iBlockSize;
+        }
+    }
+
+    bool IsImageAddress(uint64_t iValue) const
+    {
+        return iValue >= m_image.iImageBase && iValue < m_image.iImageBase + m_image.iImageSize;
+    }
+
+    // Image bytes from iRva with everything build-specific set to -1, decoding stops at the first invalid instruction or int3
+    std::vector<int> Mask(uint32_t iRva, size_t iLength, std::vector<uint32_t>& starts) const
+    {
+        std::vector<int> pattern{};
+        size_t iEnd = std::min<size_t>(m_image.data.size(), (size_t)iRva + iLength);
+        ZydisDecodedInstruction ix{};
+        for (size_t iIp = iRva; iIp < iEnd;) {
+            const uint8_t* ip = m_image.Base() + iIp;
+            if (!ZYAN_SUCCESS(ZydisDecoderDecodeInstruction(&m_decoder, nullptr, ip, std::min<size_t>(15, m_image.data.size() - iIp), &ix)))
+                break;
+            // Padding after the function, whatever follows it belongs to another function
+            if (ix.mnemonic == ZYDIS_MNEMONIC_INT3)
+                break;
+
+            starts.push_back(static_cast<uint32_t>(iIp));
+            size_t iFirst = pattern.size();
+            for (uint8_t i = 0; i < ix.length; i++)
+                pattern.push_back(m_relocated[iIp + i] ? -1 : ip[i]);
+
+            auto wildcard = [&](uint8_t iOffset, uint8_t iBits) {
+                for (uint8_t i = 0; i < iBits / 8; i++)
+                    pattern[iFirst + iOffset + i] = -1;
+            };
+
+            // [rip+disp32] always moves, struct and stack offsets only when a layout changes
+            bool bRipRelative = (ix.attributes & ZYDIS_ATTRIB_HAS_MODRM) && ix.raw.modrm.mod == 0 && ix.raw.modrm.rm == 5;
+            if (ix.raw.disp.size && (bRipRelative || ix.raw.disp.size > 8 || m_options.bStrict))
+                wildcard(ix.raw.disp.offset, ix.raw.disp.size);
+
+            // Branch targets and addresses always, small constants (flags, counts, enum values) are kept as anchors
+            for (const auto& imm : ix.raw.imm) {
+                if (!imm.size)
+                    continue;
+                bool bAddress = imm.size >= 32 && IsImageAddress(imm.value.u);
+                bool bLarge = imm.size >= 32 && (imm.is_signed ? (imm.value.s < -0x8000 || imm.value.s > 0xFFFF) : imm.value.u > 0xFFFF);
+                if (imm.is_relative || bAddress || bLarge || m_options.bStrict)
+                    wildcard(imm.offset, imm.size);
+            }
+
+            iIp += ix.length;
+        }
+
+        if (pattern.size() > iEnd - iRva)
+            pattern.resize(iEnd - iRva);
+        return pattern;
+    }
+
+    // Length at which the pattern only matches at iStart, 0 if it never does within the window
+    size_t UniqueLength(uint32_t iStart, const std::vector<int>& pattern) const
+    {
+        if (pattern.empty() || pattern[0] == -1)
+            return 0;
+
+        // Every position that still matches, narrowed one concrete byte at a time
+        const uint8_t* data = m_image.Base();
+        size_t iSize = m_image.data.size();
+        std::vector<uint32_t> positions{};
+        for (size_t i = 0; i + 1 < iSize; i++) {
+            if (data[i] == pattern[0])
+                positions.push_back(static_cast<uint32_t>(i));
+        }
+
+        for (size_t iLength = 1; iLength <= pattern.size(); iLength++) {
+            int iByte = pattern[iLength - 1];
+            if (iLength > 1 && iByte == -1)
+                continue;
+
+            std::erase_if(positions, [&](uint32_t iPosition) {
+                return (size_t)iPosition + iLength >= iSize || data[iPosition + iLength - 1] != iByte;
+            });
+            if (positions.size() == 1 && positions[0] == iStart)
+                return iLength;
+        }
+        return 0;
+    }
+};
+
+static std::string FormatPattern(const std::vector<int>& pattern)
+{
+    std::string sPattern;
+    for (int iByte : pattern) {
+        char sByte[4];
+        snprintf(sByte, sizeof(sByte), iByte == -1 ? "??" : "%02X", iByte);
+        sPattern += (sPattern.empty() ? "" : " ") + std::string(sByte);
+    }
+    return sPattern;
+}
+
+static void PrintSignature(const char* sName, const char* sFeature, const Candidate& candidate, bool bAbsolute, int iAbsoluteOffset)
+{
+    printf("    inline constexpr Signature %s{ \"%s\", \"%s\", \"%s\"", sName, sName, sFeature, FormatPattern(candidate.pattern).c_str());
+    if (bAbsolute)
+        printf(", true, %s0x%x", iAbsoluteOffset < 0 ? "-" : "", std::abs(iAbsoluteOffset));
+    printf(" };\n");
+}
+
+static int GenerateAll(const Generator& generator, const PE::Image& image, const Options& options)
+{
+    int iResult = 0;
+    size_t iOldBytes = 0, iNewBytes = 0;
+    double fOldCost = 0.0, fNewCost = 0.0;
+    printf("%-28s %8s %7s %7s %8s %8s %6s\n", "Signature", "RVA", "Old len", "New len", "Old cost", "New cost", "Shift");
+    std::vector<std::tuple<const Signatures::Signature*, uint32_t, Candidate>> results{};
+    for (const Signatures::Signature* signature : Signatures::All) {
+        auto pattern = Signatures::ParsePattern(signature->sPattern);
+        uint32_t iRva = 0;
+        size_t iMatches = generator.CountMatches(pattern, &iRva);
+        if (iMatches != 1) {
+            printf("%-28s %s, skipped\n", signature->sName, iMatches ? "ambiguous" : "not found");
+            iResult = 1;
+            continue;
+        }
+
+        Candidate candidate{};
+        if (!generator.Generate(iRva, candidate, options.bAllowShift)) {
+            printf("%-28s %8x no unique signature %s\n", signature->sName, iRva, options.bAllowShift ? "within the window" : "at the match, try --allow-shift");
+            iResult = 1;
+            continue;
+        }
+
+        // Same check as for single sites, every printed signature has to match exactly where it was generated
+        uint32_t iFirst = 0;
+        if (generator.CountMatches(candidate.pattern, &iFirst) != 1 || iFirst != candidate.iStart) {
+            printf("%-28s %8x generated signature doesn't verify, this is a bug\n", signature->sName, iRva);
+            iResult = 2;
+            continue;
+        }
+
+        double fOld = generator.Cost(pattern);
+        printf("%-28s %8x %7zu %7zu %8.3f %8.3f %+6d\n", signature->sName, iRva, pattern.size(), candidate.pattern.size(), fOld, candidate.fCost, (int)(candidate.iStart - iRva));
+        iOldBytes += pattern.size();
+        iNewBytes += candidate.pattern.size();
+        fOldCost += fOld * iRva;
+        fNewCost += candidate.fCost * candidate.iStart;
+        results.push_back({ signature, iRva, std::move(candidate) });
+    }
+
+    // Estimated compares for the whole set, each scan stops at its match
+    printf("\nTotal pattern bytes %zu -> %zu, estimated scan compares %.0f -> %.0f (image 0x%x bytes)\n\n", iOldBytes, iNewBytes, fOldCost, fNewCost, image.iImageSize);
+    // GetAbsolute() offsets follow the new start, hook offsets in dllmain.cpp have to move by the shift by hand
+    for (const auto& [signature, iRva, candidate] : results)
+        PrintSignature(signature->sName, signature->sFeature, candidate, signature->bAbsolute, signature->iAbsoluteOffset - (int)(candidate.iStart - iRva));
+    bool bNoted = false;
+    for (const auto& [signature, iRva, candidate] : results) {
+        if (candidate.iStart == iRva)
+            continue;
+        printf("%s%s starts 0x%x later, subtract 0x%x from every %sScanResult offset in %s()\n", bNoted ? "" : "\n",
+            signature->sName, candidate.iStart - iRva, candidate.iStart - iRva, signature->sName, signature->sFeature);
+        bNoted = true;
+    }
+    return iResult;
+}
+
+int main(int argc, char** argv)
+{
+    std::string sExePath;
+    std::string sName;
+    std::string sFeature = "Misc";
+    uint32_t iHook = 0;
+    bool bAll = false;
+    Options options{};
+    for (int i = 1; i < argc; i++) {
+        std::string sArg = argv[i];
+        if (sArg == "--all")
+            bAll = true;
+        else if (sArg == "--allow-shift")
+            options.bAllowShift = true;
+        else if (sArg == "--strict")
+            options.bStrict = true;
+        else if (sArg == "--name" && i + 1 < argc)
+            sName = argv[++i];
+        else if (sArg == "--feature" && i + 1 < argc)
+            sFeature = argv[++i];
+        else if (sArg == "--window" && i + 1 < argc)
+            options.iWindow = strtoul(argv[++i], nullptr, 0);
+        else if (sArg == "--min" && i + 1 < argc)
+            options.iMinLength = strtoul(argv[++i], nullptr, 0);
+        else if (sArg == "--max" && i + 1 < argc)
+            options.iMaxLength = strtoul(argv[++i], nullptr, 0);
+        else if (sExePath.empty())
+            sExePath = sArg;
+        else if (!iHook)
+            iHook = static_cast<uint32_t>(strtoul(argv[i], nullptr, 16));
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (sExePath.empty() || (!bAll && !iHook) || !options.iMaxLength) {
+        fprintf(stderr, "Usage: %s <BERSERK.exe> <hook RVA> [--name <name>] [--feature <feature>] [--window <bytes>] [--min <bytes>] [--max <bytes>] [--strict]\n", argv[0]);
+        fprintf(stderr, "       %s <BERSERK.exe> --all [--allow-shift] [--window <bytes>] [--min <bytes>] [--max <bytes>] [--strict]\n", argv[0]);
+        return 2;
+    }
+
+    PE::Image image{};
+    if (std::string sError = PE::Load(sExePath, image); !sError.empty()) {
+        fprintf(stderr, "%s: %s\n", sExePath.c_str(), sError.c_str());
+        return 2;
+    }
+    printf("%s: timestamp 0x%08x, image size 0x%x\n\n", sExePath.c_str(), image.iTimestamp, image.iImageSize);
+
+    Generator generator(image, options);
+    if (bAll)
+        return GenerateAll(generator, image, options);
+
+    if (iHook >= image.iImageSize) {
+        fprintf(stderr, "RVA 0x%x is outside the image\n", iHook);
+        return 2;
+    }
+
+    Candidate candidate{};
+    if (!generator.Generate(iHook, candidate)) {
+        printf("No unique signature of up to %zu bytes starts within 0x%zx bytes of 0x%x\n", options.iMaxLength, options.iWindow, iHook);
+        return 1;
+    }
+
+    // Same check the fix effectively makes at runtime, with the same matcher
+    uint32_t iFirst = 0;
+    if (generator.CountMatches(candidate.pattern, &iFirst) != 1 || iFirst != candidate.iStart) {
+        fprintf(stderr, "Generated signature doesn't verify, this is a bug\n");
+        return 2;
+    }
+
+    if (sName.empty()) {
+        char sBuffer[32];
+        snprintf(sBuffer, sizeof(sBuffer), "Hook%X", iHook);
+        sName = sBuffer;
+    }
+
+    printf("%zu bytes, %zu wildcards, estimated %.3f compares per scanned position\n", candidate.pattern.size(),
+        (size_t)std::count(candidate.pattern.begin(), candidate.pattern.end(), -1), candidate.fCost);
+    if (candidate.iStart != iHook)
+        printf("Matches 0x%x after the hook, hook at Memory::PatternScan(...) - 0x%x\n", candidate.iStart - iHook, candidate.iStart - iHook);
+    printf("\n");
+    PrintSignature(sName.c_str(), sFeature.c_str(), candidate, false, 0);
+    return 0;
+}
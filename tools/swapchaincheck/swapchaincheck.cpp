@@ -0,0 +1,161 @@
+// swapchaincheck - checks the flip model descriptor and flag translation in src/swapchain.hpp.
+//
+// Runs UpgradeDesc, TranslateResizeBuffers and TranslatePresentFlags against the descriptors and calls a DX11 game can
+// make: every flip-compatible format and the sRGB ones flip model rejects, MSAA, exclusive fullscreen, swapchains that
+// already use flip model, buffer counts below 2 and above DXGI_MAX_SWAP_CHAIN_BUFFERS, and DXGI_PRESENT_TEST. Rejected
+// descriptors must come back untouched. On Linux the header supplies the DXGI types itself.
+// Prints every failed case and exits non-zero if there were any.
+//
+// Build: g++ -std=c++20 -O2 -o swapchaincheck tools/swapchaincheck/swapchaincheck.cpp
+// Usage: swapchaincheck
+
+#include "../../src/swapchain.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+static int iFailures = 0;
+
+static void Check(bool bOk, const char* sCase)
+{
+    if (!bOk) {
+        fprintf(stderr, "FAIL: %s\n", sCase);
+        iFailures++;
+    }
+}
+
+// What the game creates in borderless mode: windowed, blit model, one back buffer
+static DXGI_SWAP_CHAIN_DESC GameDesc()
+{
+    DXGI_SWAP_CHAIN_DESC desc{};
+    desc.BufferDesc.Width = 2560;
+    desc.BufferDesc.Height = 1080;
+    desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.BufferCount = 1;
+    desc.Windowed = 1;
+    desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+    return desc;
+}
+
+static bool Unchanged(const DXGI_SWAP_CHAIN_DESC& a, const DXGI_SWAP_CHAIN_DESC& b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static void CheckUpgradeDesc()
+{
+    DXGI_SWAP_CHAIN_DESC desc = GameDesc();
+    Check(Swapchain::UpgradeDesc(desc, 3, false), "upgrade: windowed blit model");
+    Check(desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_DISCARD, "upgrade: swap effect is FLIP_DISCARD");
+    Check(desc.BufferCount == 3, "upgrade: buffer count raised to the requested count");
+    Check(!(desc.Flags & DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING), "upgrade: no tearing flag unless allowed");
+    Check(desc.BufferDesc.Width == 2560 && desc.BufferDesc.Height == 1080 && desc.BufferDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM, "upgrade: size and format kept");
+
+    desc = GameDesc();
+    desc.SwapEffect = DXGI_SWAP_EFFECT_SEQUENTIAL;
+    desc.Flags = 0x2;
+    Check(Swapchain::UpgradeDesc(desc, 3, true), "upgrade: sequential blit model");
+    Check(desc.Flags == (0x2 | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING), "upgrade: tearing flag added, game flags kept");
+
+    // Flip model formats
+    const DXGI_FORMAT accepted[] = { DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM };
+    for (DXGI_FORMAT format : accepted) {
+        desc = GameDesc();
+        desc.BufferDesc.Format = format;
+        Check(Swapchain::UpgradeDesc(desc, 3, false), "upgrade: flip compatible format");
+    }
+
+    // Everything that has to be left alone
+    auto rejected = [](DXGI_SWAP_CHAIN_DESC desc, const char* sCase) {
+        DXGI_SWAP_CHAIN_DESC original = desc;
+        Check(!Swapchain::UpgradeDesc(desc, 3, true) && Unchanged(desc, original), sCase);
+    };
+
+    desc = GameDesc();
+    desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    rejected(desc, "reject: R8G8B8A8 sRGB back buffer");
+    desc.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+    rejected(desc, "reject: B8G8R8A8 sRGB back buffer");
+    desc.BufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+    rejected(desc, "reject: unknown format");
+
+    desc = GameDesc();
+    desc.SampleDesc.Count = 4;
+    rejected(desc, "reject: 4x MSAA back buffer");
+
+    desc = GameDesc();
+    desc.Windowed = 0;
+    rejected(desc, "reject: exclusive fullscreen");
+
+    desc = GameDesc();
+    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    desc.BufferCount = 2;
+    rejected(desc, "reject: already FLIP_DISCARD");
+    desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+    rejected(desc, "reject: already FLIP_SEQUENTIAL");
+
+    // Buffer count stays within 2 and DXGI_MAX_SWAP_CHAIN_BUFFERS, and never drops below what the game asked for
+    desc = GameDesc();
+    Swapchain::UpgradeDesc(desc, 0, false);
+    Check(desc.BufferCount == 2, "buffers: raised to the flip model minimum of 2");
+    desc = GameDesc();
+    Swapchain::UpgradeDesc(desc, 40, false);
+    Check(desc.BufferCount == DXGI_MAX_SWAP_CHAIN_BUFFERS, "buffers: clamped to DXGI_MAX_SWAP_CHAIN_BUFFERS");
+    desc = GameDesc();
+    desc.BufferCount = 4;
+    Swapchain::UpgradeDesc(desc, 2, false);
+    Check(desc.BufferCount == 4, "buffers: game's larger count kept");
+}
+
+static void CheckResizeBuffers()
+{
+    UINT iBufferCount = 0;
+    UINT iFlags = 0;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 3, false);
+    Check(iBufferCount == 0 && iFlags == 0, "resize: 0 keeps the current buffer count");
+
+    iBufferCount = 1;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 3, false);
+    Check(iBufferCount == 3, "resize: raised to the upgraded buffer count");
+
+    iBufferCount = 1;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 1, false);
+    Check(iBufferCount == 2, "resize: raised to the flip model minimum of 2");
+
+    iBufferCount = 40;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 3, false);
+    Check(iBufferCount == DXGI_MAX_SWAP_CHAIN_BUFFERS, "resize: clamped to DXGI_MAX_SWAP_CHAIN_BUFFERS");
+
+    iBufferCount = 0;
+    iFlags = 0x2;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 3, true);
+    Check(iFlags == (0x2 | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING), "resize: tearing creation flag kept");
+
+    iFlags = 0x2;
+    Swapchain::TranslateResizeBuffers(iBufferCount, iFlags, 3, false);
+    Check(iFlags == 0x2, "resize: no tearing flag unless the swapchain has it");
+}
+
+static void CheckPresentFlags()
+{
+    Check(Swapchain::TranslatePresentFlags(0, 0, true) == DXGI_PRESENT_ALLOW_TEARING, "present: sync interval 0 tears");
+    Check(Swapchain::TranslatePresentFlags(1, 0, true) == 0, "present: vsync never tears");
+    Check(Swapchain::TranslatePresentFlags(0, 0, false) == 0, "present: no tearing without the flag");
+    Check(Swapchain::TranslatePresentFlags(0, DXGI_PRESENT_TEST, true) == DXGI_PRESENT_TEST, "present: DXGI_PRESENT_TEST left alone");
+    Check(Swapchain::TranslatePresentFlags(0, 0x4, true) == (0x4 | DXGI_PRESENT_ALLOW_TEARING), "present: game flags kept");
+}
+
+int main()
+{
+    CheckUpgradeDesc();
+    CheckResizeBuffers();
+    CheckPresentFlags();
+
+    if (iFailures) {
+        fprintf(stderr, "%d failures\n", iFailures);
+        return 1;
+    }
+    printf("swapchaincheck: ok\n");
+    return 0;
+}